@@ -0,0 +1,9 @@
+# Stand-alone benchmark programs, built into bin/ next to the application;
+# each prints its results and exits:
+#   cd benchmarks && qmake && make && ../bin/bench-ingest && ../bin/bench-decimation
+# bench-plotting draws plots and needs a display, or an offscreen one:
+#   QT_QPA_PLATFORM=offscreen ../bin/bench-plotting
+
+TEMPLATE = subdirs
+
+SUBDIRS = ingest decimation plotting
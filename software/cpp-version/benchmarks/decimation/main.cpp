@@ -0,0 +1,114 @@
+#include <QElapsedTimer>
+#include <QVector>
+#include <cstdio>
+#include <random>
+
+#include "decimation.h"
+#include "samplestore.h"
+
+// Cost of reducing a trace to pixel columns: every min/max kernel the CPU can
+// run over one long buffer, then SampleStore::decimate() against scanning
+// every sample of the window, for windows of growing length. The rate at which
+// the store was filled, pyramid upkeep included, is reported alongside.
+
+#define BENCH_KERNEL_SAMPLES (1 << 20)
+#define BENCH_COLUMNS 1000
+#define BENCH_MIN_NSECS 200000000LL
+
+// A random walk, so neighbouring samples are close like a real trace's.
+static void fillStore(SampleStore &store, qint64 count) {
+    std::mt19937 random(1);
+    int value = 0;
+    for (qint64 i = 0; i < count; ++i) {
+        value = qBound(-2048, value + int(random() % 33) - 16, 2047);
+        int16_t sample = int16_t(value);
+        store.append(&sample);
+    }
+}
+
+static void benchmarkKernels(void) {
+    QVector<int16_t> data(BENCH_KERNEL_SAMPLES);
+    std::mt19937 random(1);
+    for (int16_t &sample : data) {
+        sample = int16_t(random());
+    }
+
+    for (int k = 0; k < minMaxKernelCount(); ++k) {
+        int16_t min = INT16_MAX;
+        int16_t max = INT16_MIN;
+        qint64 rounds = 0;
+        QElapsedTimer timer;
+        timer.start();
+        do {
+            minMaxCountsWith(k, data.constData(), data.size(), &min, &max);
+            ++rounds;
+        } while (timer.nsecsElapsed() < BENCH_MIN_NSECS);
+        double seconds = timer.nsecsElapsed() / 1e9;
+        printf("min/max %-8s %8.0f M samples/s%s\n", minMaxKernelName(k), rounds * data.size() / seconds / 1e6,
+               k == minMaxKernelCount() - 1 ? "  (in use)" : "");
+    }
+}
+
+static void scanColumns(const SampleStore &store, const qint64 *bounds, ColumnM4 *out) {
+    for (int c = 0; c < BENCH_COLUMNS; ++c) {
+        ColumnM4 &column = out[c];
+        column.first = store.rawAt(0, bounds[c]);
+        column.last = store.rawAt(0, bounds[c + 1] - 1);
+        column.min = INT16_MAX;
+        column.max = INT16_MIN;
+        for (qint64 i = bounds[c]; i < bounds[c + 1]; ++i) {
+            int16_t sample = store.rawAt(0, i);
+            column.min = qMin(column.min, sample);
+            column.max = qMax(column.max, sample);
+        }
+    }
+}
+
+static void benchmarkDecimation(qint64 samples) {
+    SampleStore store(1, samples);
+    QElapsedTimer fillTimer;
+    fillTimer.start();
+    fillStore(store, samples);
+    double fillRate = samples / (fillTimer.nsecsElapsed() / 1e9) / 1e6;
+
+    // The window starts off the pyramid's bucket boundaries, like a panned view.
+    qint64 bounds[BENCH_COLUMNS + 1];
+    qint64 start = store.firstIndex() + 7;
+    qint64 length = store.endIndex() - start;
+    for (int c = 0; c <= BENCH_COLUMNS; ++c) {
+        bounds[c] = start + length * c / BENCH_COLUMNS;
+    }
+
+    ColumnM4 fast[BENCH_COLUMNS];
+    ColumnM4 slow[BENCH_COLUMNS];
+    double nsecs[2];
+    for (int method = 0; method < 2; ++method) {
+        qint64 rounds = 0;
+        QElapsedTimer timer;
+        timer.start();
+        do {
+            if (method == 0) {
+                store.decimate(0, bounds, BENCH_COLUMNS, fast);
+            } else {
+                scanColumns(store, bounds, slow);
+            }
+            ++rounds;
+        } while (timer.nsecsElapsed() < BENCH_MIN_NSECS);
+        nsecs[method] = double(timer.nsecsElapsed()) / rounds;
+    }
+
+    bool same = true;
+    for (int c = 0; c < BENCH_COLUMNS; ++c) {
+        same = same && fast[c].first == slow[c].first && fast[c].min == slow[c].min && fast[c].max == slow[c].max && fast[c].last == slow[c].last;
+    }
+    printf("decimate %9lld -> %d  %10.1f us pyramid  %10.1f us scan  %6.1fx  (appended at %.0f M samples/s)%s\n", (long long)length, BENCH_COLUMNS,
+           nsecs[0] / 1e3, nsecs[1] / 1e3, nsecs[1] / nsecs[0], fillRate, same ? "" : "  MISMATCH");
+}
+
+int main(void) {
+    benchmarkKernels();
+    for (qint64 samples : {100000LL, 1000000LL, 10000000LL}) {
+        benchmarkDecimation(samples);
+    }
+    return 0;
+}
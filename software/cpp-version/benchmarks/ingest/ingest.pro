@@ -0,0 +1,16 @@
+QT = core serialport
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+QMAKE_CXXFLAGS += -std=c++17
+
+DESTDIR = $$PWD/../../bin
+OBJECTS_DIR = obj
+MOC_DIR = moc
+
+TARGET = bench-ingest
+TEMPLATE = app
+
+include(../../core.pri)
+
+SOURCES += main.cpp
@@ -0,0 +1,175 @@
+#include <QElapsedTimer>
+#include <QVector>
+#include <QByteArray>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "streamsource.h"
+#include "syntheticsource.h"
+#include "sourcereader.h"
+#include "samplestore.h"
+
+// Throughput and latency of the acquisition path without a board: the
+// firmware's text protocol replayed from memory through LineParser, the same
+// through a SourceReader thread into a SampleStore, and a fast SyntheticSource
+// polled the way the GUI polls its sources.
+
+#define BENCH_CHANNELS 4
+#define BENCH_LINES 20000
+#define BENCH_FRAMES 20000000
+#define BENCH_STORE_CAPACITY (1 << 22)
+#define BENCH_SYNTHETIC_RATE 1e6
+#define BENCH_LATENCY_MSECS 3000
+#define BENCH_POLL_MSECS 1
+
+// Serves the same block of lines over and over until the requested number of
+// bytes has gone out, one read's worth per readFrames() like a port that
+// always has a full buffer waiting.
+class MemorySource : public StreamSource {
+public:
+    MemorySource(const QByteArray &text, qint64 total) : StreamSource(BENCH_CHANNELS), text(text), total(total), served(0), opened(false), ready(false) {}
+
+    QString name(void) const override { return "Memory"; }
+    bool open(QString *error) override { Q_UNUSED(error); resetStream(); served = 0; opened = true; return true; }
+    void close(void) override { opened = false; }
+    bool isOpen(void) const override { return opened; }
+    bool atEnd(void) const override { return served >= total && lineParser().bufferedBytes() == 0; }
+
+    int readFrames(int16_t *frames, qint64 *timestamps, int maxFrames) override {
+        ready = true;
+        return StreamSource::readFrames(frames, timestamps, maxFrames);
+    }
+
+protected:
+    qint64 readBytes(char *data, qint64 maxSize) override {
+        if (!ready) {
+            return 0;
+        }
+        ready = false;
+        qint64 size = qMin(maxSize, total - served);
+        for (qint64 done = 0; done < size;) {
+            qint64 offset = (served + done) % text.size();
+            qint64 chunk = qMin(size - done, text.size() - offset);
+            memcpy(data + done, text.constData() + offset, chunk);
+            done += chunk;
+        }
+        served += size;
+        return size;
+    }
+
+private:
+    QByteArray text;
+    qint64 total;
+    qint64 served;
+    bool opened;
+    bool ready;
+};
+
+static QByteArray firmwareLines(int lines) {
+    QByteArray text;
+    char line[64];
+    for (int i = 0; i < lines; ++i) {
+        int size = snprintf(line, sizeof(line), "%d\t%d\t%d\t%d\r\n", i % 1024, (i * 7) % 1024, 512, 1023 - i % 1024);
+        text.append(line, size);
+    }
+    return text;
+}
+
+static void benchmarkParser(const QByteArray &text) {
+    qint64 bytes = qint64(text.size()) * (BENCH_FRAMES / BENCH_LINES);
+    MemorySource source(text, bytes);
+    source.open(nullptr);
+    QVector<int16_t> frames(READER_BATCH_FRAMES * BENCH_CHANNELS);
+    QVector<qint64> timestamps(READER_BATCH_FRAMES);
+
+    QElapsedTimer timer;
+    timer.start();
+    qint64 total = 0;
+    while (!source.atEnd()) {
+        total += source.readFrames(frames.data(), timestamps.data(), READER_BATCH_FRAMES);
+    }
+    double seconds = timer.nsecsElapsed() / 1e9;
+    printf("parser            %8.1f MB/s  %8.2f M frames/s  (%lld frames, %lld errors)\n",
+           bytes / seconds / 1e6, total / seconds / 1e6, (long long)total, (long long)source.lineParser().parseErrors());
+}
+
+static void benchmarkPipeline(const QByteArray &text) {
+    qint64 bytes = qint64(text.size()) * (BENCH_FRAMES / BENCH_LINES);
+    MemorySource source(text, bytes);
+    QElapsedTimer epoch;
+    epoch.start();
+    SourceReader reader(&source, &epoch);
+    SampleStore store(BENCH_CHANNELS, BENCH_STORE_CAPACITY);
+
+    QElapsedTimer timer;
+    timer.start();
+    QString error;
+    if (!reader.open(&error)) {
+        fprintf(stderr, "pipeline: %s\n", qPrintable(error));
+        return;
+    }
+    FrameBlock block;
+    while (!reader.atEnd()) {
+        if (!reader.takeBlock(block)) {
+            QThread::yieldCurrentThread();
+            continue;
+        }
+        for (int i = 0; i < block.count; ++i) {
+            store.append(block.frames.constData() + i * BENCH_CHANNELS);
+        }
+    }
+    double seconds = timer.nsecsElapsed() / 1e9;
+    reader.close();
+    // The reader isn't paced by a port here, so whatever the consumer can't
+    // keep up with is dropped; the stored rate is what the consumer sustains.
+    printf("reader + store    %8.1f MB/s  %8.2f M frames/s stored  (%lld stored, %lld dropped)\n",
+           bytes / seconds / 1e6, store.endIndex() / seconds / 1e6, (long long)store.endIndex(), (long long)reader.droppedFrames());
+}
+
+// Time from a frame being due at the source to the consumer holding it, for
+// the newest frame of every block.
+static void benchmarkLatency(void) {
+    SyntheticSource source(BENCH_CHANNELS, BENCH_SYNTHETIC_RATE);
+    QElapsedTimer epoch;
+    epoch.start();
+    SourceReader reader(&source, &epoch);
+    QString error;
+    if (!reader.open(&error)) {
+        fprintf(stderr, "latency: %s\n", qPrintable(error));
+        return;
+    }
+
+    QVector<qint64> latencies;
+    latencies.reserve(BENCH_LATENCY_MSECS * 16);
+    qint64 frames = 0;
+    FrameBlock block;
+    QElapsedTimer timer;
+    timer.start();
+    while (timer.elapsed() < BENCH_LATENCY_MSECS) {
+        while (reader.takeBlock(block)) {
+            latencies.append(epoch.nsecsElapsed() - block.timestamps[block.count - 1]);
+            frames += block.count;
+        }
+        QThread::msleep(BENCH_POLL_MSECS);
+    }
+    double seconds = timer.nsecsElapsed() / 1e9;
+    reader.close();
+    if (latencies.isEmpty()) {
+        printf("synthetic latency: no frames\n");
+        return;
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    printf("synthetic latency %8.3f ms median  %8.3f ms p99  %8.3f ms max  (%.2f M frames/s, %lld dropped)\n",
+           latencies[latencies.size() / 2] / 1e6, latencies[latencies.size() * 99 / 100] / 1e6, latencies.last() / 1e6,
+           frames / seconds / 1e6, (long long)reader.droppedFrames());
+}
+
+int main(void) {
+    QByteArray text = firmwareLines(BENCH_LINES);
+    benchmarkParser(text);
+    benchmarkPipeline(text);
+    benchmarkLatency();
+    return 0;
+}
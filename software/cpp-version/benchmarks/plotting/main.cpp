@@ -0,0 +1,102 @@
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QVector>
+#include <cstdio>
+#include <random>
+
+#include "qcustomplot.h"
+#include "samplestore.h"
+#include "storetrace.h"
+
+// Cost of a frame of the main plot, for windows of growing length: the same
+// samples drawn by a QCPGraph with adaptive sampling, which has to be handed a
+// copy of them with setData(), and by a StoreTrace reading the SampleStore
+// they were appended to. Both replot an offscreen plot of the same size; run
+// with QT_QPA_PLATFORM=offscreen where there is no display. Both use the
+// application's pen; the worker threads and OpenGL are left out.
+
+#define BENCH_WIDTH 1600
+#define BENCH_HEIGHT 600
+#define BENCH_MIN_NSECS 1000000000LL
+
+// A random walk, so neighbouring samples are close like a real trace's.
+static void fillStore(SampleStore &store, qint64 count) {
+    std::mt19937 random(1);
+    int value = 0;
+    for (qint64 i = 0; i < count; ++i) {
+        value = qBound(-2048, value + int(random() % 33) - 16, 2047);
+        int16_t sample = int16_t(value);
+        store.append(&sample);
+    }
+}
+
+static void setupPlot(QCustomPlot &plot, qint64 samples) {
+    plot.resize(BENCH_WIDTH, BENCH_HEIGHT);
+    plot.xAxis->setRange(0, samples - 1);
+    plot.yAxis->setRange(-2048, 2047);
+    plot.show();
+    plot.replot(QCustomPlot::rpImmediate);
+}
+
+// Average time of one replot(), with whatever has to happen before each.
+template <typename Prepare>
+static double timeReplots(QCustomPlot &plot, Prepare prepare) {
+    qint64 rounds = 0;
+    QElapsedTimer timer;
+    timer.start();
+    do {
+        prepare();
+        plot.replot(QCustomPlot::rpImmediate);
+        ++rounds;
+    } while (timer.nsecsElapsed() < BENCH_MIN_NSECS);
+    return double(timer.nsecsElapsed()) / rounds;
+}
+
+static void benchmarkPlotting(qint64 samples) {
+    SampleStore store(1, samples);
+    fillStore(store, samples);
+
+    QVector<double> keys(int(samples));
+    QVector<double> values(int(samples));
+    for (int i = 0; i < samples; ++i) {
+        keys[i] = i;
+        values[i] = store.rawAt(0, i);
+    }
+
+    double graphNsecs;
+    double copyNsecs;
+    {
+        QCustomPlot plot;
+        QCPGraph *graph = plot.addGraph();
+        graph->setAdaptiveSampling(true);
+        graph->setPen(QPen(Qt::blue, 2));
+        graph->setData(keys, values);
+        setupPlot(plot, samples);
+        graphNsecs = timeReplots(plot, []() {});
+        // As while acquiring, where every frame hands the graph new data.
+        copyNsecs = timeReplots(plot, [&]() { graph->setData(keys, values); });
+    }
+
+    double traceNsecs;
+    {
+        QCustomPlot plot;
+        StoreTrace *trace = new StoreTrace(plot.xAxis, plot.yAxis);
+        plot.addPlottable(trace);
+        trace->setPen(QPen(Qt::blue, 2));
+        trace->setStore(&store, 0);
+        trace->setTimeBase(0, 1);
+        setupPlot(plot, samples);
+        traceNsecs = timeReplots(plot, []() {});
+    }
+
+    printf("replot %9lld samples  %10.1f ms QCPGraph  %10.1f ms with setData()  %10.1f ms StoreTrace  %6.1fx\n", (long long)samples,
+           graphNsecs / 1e6, copyNsecs / 1e6, traceNsecs / 1e6, copyNsecs / traceNsecs);
+}
+
+int main(int argc, char *argv[]) {
+    QApplication app(argc, argv);
+    for (qint64 samples : {100000LL, 1000000LL, 10000000LL}) {
+        benchmarkPlotting(samples);
+    }
+    return 0;
+}
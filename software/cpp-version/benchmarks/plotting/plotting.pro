@@ -0,0 +1,28 @@
+QT = core gui serialport widgets printsupport
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+QMAKE_CXXFLAGS += -std=c++17
+
+DESTDIR = $$PWD/../../bin
+OBJECTS_DIR = obj
+MOC_DIR = moc
+
+INCLUDEPATH += ../../lib \
+               ../../lib/qcustomplot
+
+TARGET = bench-plotting
+TEMPLATE = app
+
+include(../../core.pri)
+
+SOURCES += \
+    main.cpp \
+    ../../src/storetrace.cpp \
+    ../../src/gltraceview.cpp \
+    ../../lib/qcustomplot/qcustomplot.cpp
+
+HEADERS += \
+    ../../include/storetrace.h \
+    ../../include/gltraceview.h \
+    ../../lib/qcustomplot/qcustomplot.h
@@ -0,0 +1,50 @@
+# Acquisition, decoding and capture code shared by the GUI and the headless
+# command-line tool; nothing here depends on QtWidgets.
+
+QT += network
+
+INCLUDEPATH += $$PWD/include
+
+SOURCES += \
+    $$PWD/src/samplestore.cpp \
+    $$PWD/src/decimation.cpp \
+    $$PWD/src/capturewriter.cpp \
+    $$PWD/src/capturereader.cpp \
+    $$PWD/src/capturereplay.cpp \
+    $$PWD/src/lineparser.cpp \
+    $$PWD/src/streamsource.cpp \
+    $$PWD/src/serialsource.cpp \
+    $$PWD/src/bauddetector.cpp \
+    $$PWD/src/syntheticsource.cpp \
+    $$PWD/src/clockmodel.cpp \
+    $$PWD/src/sourcereader.cpp \
+    $$PWD/src/multisource.cpp \
+    $$PWD/src/sampleserver.cpp
+
+HEADERS += \
+    $$PWD/include/samplestore.h \
+    $$PWD/include/decimation.h \
+    $$PWD/include/captureformat.h \
+    $$PWD/include/capturewriter.h \
+    $$PWD/include/capturereader.h \
+    $$PWD/include/capturereplay.h \
+    $$PWD/include/datasource.h \
+    $$PWD/include/lineparser.h \
+    $$PWD/include/streamsource.h \
+    $$PWD/include/serialsource.h \
+    $$PWD/include/bauddetector.h \
+    $$PWD/include/syntheticsource.h \
+    $$PWD/include/clockmodel.h \
+    $$PWD/include/sourcereader.h \
+    $$PWD/include/multisource.h \
+    $$PWD/include/serverformat.h \
+    $$PWD/include/sampleserver.h
+
+unix {
+    SOURCES += $$PWD/src/ptysource.cpp \
+               $$PWD/src/sharedringpublisher.cpp
+    HEADERS += $$PWD/include/ptysource.h \
+               $$PWD/include/sharedring.h \
+               $$PWD/include/sharedringpublisher.h
+    linux: LIBS += -lrt
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <QObject>
+#include <QVector>
+#include <cstdint>
+
+#include "datasource.h"
+#include "samplestore.h"
+#include "capturewriter.h"
+#include "sampleserver.h"
+#include "clockmodel.h"
+#include "phosphor.h"
+#ifdef Q_OS_UNIX
+#include "sharedringpublisher.h"
+#endif
+
+#define ACQUISITION_BATCH_FRAMES 4096
+#define ACQUISITION_POLL_LIMIT (16 * ACQUISITION_BATCH_FRAMES)
+
+struct AcquisitionStats {
+    qint64 frames = 0;
+    int channels = 0;
+    SourceStats source;
+    qint64 writerDroppedFrames = 0;
+    qint64 serverDroppedFrames = 0;
+    qint64 phosphorDroppedFrames = 0;
+};
+
+// The ingestion pipeline: pulls frames from whichever DataSource is attached
+// and hands them to the sample store and, while recording, the capture writer.
+// Sources with a different channel count are truncated or zero-padded. An
+// optional SampleServer and shared-memory ring get every batch as decoded,
+// for local clients, and so does an optional Phosphor for the persistence
+// view. A ClockModel fitted to the batches' host timestamps turns sample
+// indices into seconds even though the firmware sends no time.
+class Acquisition : public QObject {
+    Q_OBJECT
+
+public:
+    Acquisition(int channels, SampleStore *store, CaptureWriter *writer, QObject *parent = nullptr);
+    ~Acquisition(void);
+
+    void setSinks(int channels, SampleStore *store, CaptureWriter *writer);
+    void setServer(SampleServer *server);
+    void setPhosphor(Phosphor *phosphor);
+#ifdef Q_OS_UNIX
+    void setSharedRing(SharedRingPublisher *ring);
+#endif
+    void setSource(DataSource *source);
+    DataSource *source(void) const { return dataSource; }
+
+    bool start(QString *error);
+    void stop(void);
+    bool isRunning(void) const { return running; }
+    void pause(void);
+    bool resume(QString *error);
+
+    int poll(void);
+    AcquisitionStats stats(void) const;
+
+    const ClockModel &clockModel(void) const { return clock; }
+    void resetClock(void);
+    bool sampleTimeBase(double *origin, double *period) const;
+
+private:
+    void applyScales(void);
+    void ingest(const int16_t *frames, const qint64 *timestamps, int count, int sourceChannels);
+    void observeTimestamps(const qint64 *timestamps, int count);
+
+    int channels;
+    SampleStore *store;
+    CaptureWriter *writer;
+    SampleServer *server;
+    Phosphor *phosphor;
+#ifdef Q_OS_UNIX
+    SharedRingPublisher *ring;
+#endif
+    DataSource *dataSource;
+    bool running;
+    qint64 ingestedFrames;
+    qint64 clockStart;
+    ClockModel clock;
+    QVector<int16_t> frameBuffer;
+    QVector<qint64> timestampBuffer;
+    QVector<int16_t> frame;
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <QThread>
+#include <QString>
+#include <QVector>
+#include <QByteArray>
+
+#define BAUD_DETECT_SETTLE_MS 2500
+#define BAUD_DETECT_PROBE_MS 300
+#define BAUD_DETECT_PROBE_BYTES 1024
+#define BAUD_DETECT_MIN_LINES 4
+#define BAUD_DETECT_LOCK_SCORE 0.9
+#define BAUD_DETECT_MIN_SCORE 0.5
+
+// Finds the baud rate (and channel count) of a board speaking the firmware's
+// text protocol. The port is opened once, so a board that resets on DTR only
+// resets once; after waiting for it to start talking, each candidate rate is
+// tried for up to BAUD_DETECT_PROBE_MS and the bytes are scored by how much of
+// them forms well-formed lines. The first rate scoring BAUD_DETECT_LOCK_SCORE
+// wins at once, otherwise the best one after all candidates if it reaches
+// BAUD_DETECT_MIN_SCORE.
+class BaudDetector : public QThread {
+    Q_OBJECT
+
+public:
+    explicit BaudDetector(const QString &portName, QObject *parent = nullptr);
+
+    static QVector<int> candidates(void);
+    static double scoreLines(const QByteArray &data, int *channels);
+
+    int baudRate(void) const { return detectedBaud; }
+    int channelCount(void) const { return detectedChannels; }
+    double score(void) const { return bestScore; }
+    QString errorString(void) const { return error; }
+
+signals:
+    void detected(int baudRate, int channels);
+    void failed(const QString &message);
+
+protected:
+    void run(void) override;
+
+private:
+    QString portName;
+    int detectedBaud;
+    int detectedChannels;
+    double bestScore;
+    QString error;
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <QtGlobal>
+
+// On-disk layout of a .uscap capture file (little-endian, naturally aligned):
+//
+//   CaptureHeader                      at offset 0, patched when recording stops
+//   CaptureChunkHeader + payload       repeated, payload is frames * qint64
+//                                      timestamps followed by channels * frames
+//                                      int16_t counts stored channel by channel
+//   CaptureIndexEntry[chunkCount]      at indexOffset, sorted by firstFrame
+//
+// A file whose indexOffset is still 0 was not closed cleanly; its chunks can be
+// recovered by walking the chunk headers from the end of the file header.
+
+#define CAPTURE_MAGIC "UASCAP01"
+#define CAPTURE_CHUNK_MAGIC 0x4b4e4843u // "CHNK"
+#define CAPTURE_VERSION 1
+#define CAPTURE_MAX_CHANNELS 16
+#define CAPTURE_CHUNK_FRAMES 16384
+#define CAPTURE_EXTENSION "uscap"
+
+struct CaptureCalibration {
+    double gain;
+    double offset;
+    char unit[8];
+};
+
+struct CaptureHeader {
+    char magic[8];
+    quint32 version;
+    quint32 channels;
+    double sampleRate;
+    qint64 startTime;
+    quint64 indexOffset;
+    quint64 chunkCount;
+    quint64 frameCount;
+    CaptureCalibration calibration[CAPTURE_MAX_CHANNELS];
+};
+
+struct CaptureChunkHeader {
+    quint32 magic;
+    quint32 frames;
+    quint64 firstFrame;
+};
+
+struct CaptureIndexEntry {
+    quint64 firstFrame;
+    quint64 offset;
+    qint64 firstTimestamp;
+};
+
+static_assert(sizeof(CaptureHeader) == 56 + CAPTURE_MAX_CHANNELS * 24, "unexpected padding in CaptureHeader");
+static_assert(sizeof(CaptureChunkHeader) == 16, "unexpected padding in CaptureChunkHeader");
+static_assert(sizeof(CaptureIndexEntry) == 24, "unexpected padding in CaptureIndexEntry");
+
+inline qint64 captureChunkPayloadSize(quint32 channels, quint32 frames) {
+    return qint64(frames) * (sizeof(qint64) + channels * sizeof(qint16));
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <QFile>
+#include <QVector>
+#include <cstdint>
+
+#include "captureformat.h"
+#include "samplestore.h"
+
+struct CaptureChunk {
+    quint64 firstFrame = 0;
+    int frames = 0;
+    QVector<qint64> timestamps;
+    QVector<int16_t> samples;
+
+    const int16_t *channelData(int channel) const { return samples.constData() + channel * frames; }
+};
+
+// Random access to a capture file written by CaptureWriter. The chunk index is
+// loaded on open (or rebuilt by walking the chunks of a file that was never
+// closed) so any frame is one binary search and one chunk read away.
+class CaptureReader {
+public:
+    CaptureReader(void);
+    ~CaptureReader(void);
+
+    bool open(const QString &path, QString *error);
+    void close(void);
+    bool isOpen(void) const { return file.isOpen(); }
+
+    int channelCount(void) const { return header.channels; }
+    quint64 frameCount(void) const { return frames; }
+    double sampleRate(void) const { return header.sampleRate; }
+    qint64 startTime(void) const { return header.startTime; }
+    ChannelScale scale(int channel) const;
+
+    int chunkCount(void) const { return index.size(); }
+    // 0 when the capture has no chunks, which readChunk() then refuses.
+    int chunkForFrame(quint64 frame) const;
+    int chunkForTimestamp(qint64 timestamp) const;
+    const CaptureIndexEntry &chunkEntry(int chunk) const { return index[chunk]; }
+    bool readChunk(int chunk, CaptureChunk &out);
+
+private:
+    bool rebuildIndex(void);
+
+    QFile file;
+    CaptureHeader header;
+    QVector<CaptureIndexEntry> index;
+    quint64 frames;
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <QElapsedTimer>
+
+#include "datasource.h"
+#include "capturereader.h"
+
+#define REPLAY_SPEED_MAX 0.0
+
+// Plays a capture file back as if it was arriving live. Frames are released by
+// readFrames() once their recorded timestamp is due on the replay clock, which
+// runs at speed() times real time (or without any pacing at REPLAY_SPEED_MAX).
+class CaptureReplay : public DataSource {
+    Q_OBJECT
+
+public:
+    explicit CaptureReplay(const QString &path, QObject *parent = nullptr);
+
+    QString name(void) const override { return fileName; }
+    bool open(QString *error) override;
+    void close(void) override;
+    bool isOpen(void) const override { return reader.isOpen(); }
+    bool atEnd(void) const override { return position >= reader.frameCount(); }
+    bool isLive(void) const override { return false; }
+    void pause(void) override;
+    bool resume(QString *error) override;
+
+    int channelCount(void) const override { return reader.channelCount(); }
+    ChannelScale scale(int channel) const override { return reader.scale(channel); }
+    quint64 frameCount(void) const { return reader.frameCount(); }
+    quint64 currentFrame(void) const { return position; }
+
+    void setSpeed(double factor);
+    double speed(void) const { return speedFactor; }
+    bool seek(quint64 frame);
+
+    int readFrames(int16_t *frames, qint64 *timestamps, int maxFrames) override;
+
+private:
+    bool loadChunkFor(quint64 frame);
+    void restartClock(void);
+
+    QString fileName;
+    CaptureReader reader;
+    CaptureChunk chunk;
+    int chunkIndex;
+    quint64 position;
+
+    double speedFactor;
+    bool isPaused;
+    QElapsedTimer clock;
+    qint64 anchorTimestamp;
+};
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <QThread>
+#include <QFile>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QVector>
+#include <QQueue>
+#include <QAtomicInteger>
+#include <cstdint>
+
+#include "captureformat.h"
+#include "samplestore.h"
+
+#define CAPTURE_POOL_CHUNKS 8
+#define CAPTURE_FLUSH_INTERVAL_NS 1000000000LL
+
+// Streams frames to a capture file from a background thread. append() only
+// fills a preallocated chunk and hands complete chunks over under a short lock,
+// so the caller never waits on the disk; if every pooled chunk is still queued
+// for writing the frame is dropped and counted instead. A blocking writer waits
+// for a chunk to be written in that case, for sources that can be held back.
+class CaptureWriter : public QThread {
+    Q_OBJECT
+
+public:
+    explicit CaptureWriter(int channels, QObject *parent = nullptr);
+    ~CaptureWriter(void);
+
+    bool open(const QString &path, const QVector<ChannelScale> &scales, QString *error);
+    void close(void);
+    bool isRecording(void) const { return recording; }
+    void setBlocking(bool blocking) { waitForChunks = blocking; }
+
+    void append(const int16_t *frame, qint64 timestamp);
+
+    qint64 framesWritten(void) const { return writtenFrames.loadAcquire(); }
+    qint64 droppedFrames(void) const { return lostFrames.loadAcquire(); }
+
+signals:
+    void writeError(const QString &message);
+
+protected:
+    void run(void) override;
+
+private:
+    struct Chunk {
+        quint64 firstFrame;
+        int frames;
+        QVector<qint64> timestamps;
+        QVector<int16_t> samples;
+    };
+
+    Chunk *takeFreeChunk(void);
+    void submitCurrent(void);
+    bool writeChunk(const Chunk *chunk);
+    bool finish(void);
+
+    int channels;
+    bool recording;
+    bool waitForChunks;
+    QFile file;
+    CaptureHeader header;
+    QVector<CaptureIndexEntry> index;
+
+    QVector<Chunk*> pool;
+    Chunk *current;
+    quint64 nextFrame;
+    qint64 firstTimestamp;
+    qint64 lastTimestamp;
+
+    QMutex mutex;
+    QWaitCondition chunkReady;
+    QWaitCondition chunkFree;
+    QQueue<Chunk*> pending;
+    QVector<Chunk*> freeChunks;
+    bool stopping;
+    bool failed;
+
+    QAtomicInteger<qint64> writtenFrames;
+    QAtomicInteger<qint64> lostFrames;
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <QtGlobal>
+
+#define CLOCK_MODEL_DECAY 0.999
+#define CLOCK_MODEL_MIN_JITTER_NS 50000.0
+
+// Linear model of a device clock seen from the host: hostTime = offset + frame
+// * period, fitted by exponentially weighted least squares over (frame index,
+// host arrival time) observations. USB and scheduling latency only ever delay
+// an arrival, so observations late by more than the typical jitter are
+// down-weighted and the fit hugs the early edge of the arrivals.
+class ClockModel {
+public:
+    ClockModel(void);
+
+    void reset(void);
+    void addObservation(qint64 frame, qint64 hostTime);
+
+    bool isValid(void) const;
+    double timeOf(double frame) const;
+    double frameAt(double hostTime) const;
+    double period(void) const;
+    double rate(void) const { return isValid() ? 1e9 / period() : 0.0; }
+    double jitter(void) const { return jitterScale; }
+
+private:
+    void fit(double *slope, double *intercept) const;
+
+    int observations;
+    qint64 originFrame;
+    qint64 originTime;
+    double sum;
+    double sumX;
+    double sumY;
+    double sumXX;
+    double sumXY;
+    double jitterScale;
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <QFile>
+#include <QByteArray>
+#include <QVector>
+#include <cstdint>
+
+#include "samplestore.h"
+
+#define CSV_FLUSH_BYTES (1 << 20)
+#define CSV_EXTENSION "csv"
+
+// Writes frames as comma-separated text: the timestamp in seconds followed by
+// one scaled value per channel. Rows are formatted into a memory buffer and
+// written out in large blocks.
+class CsvWriter {
+public:
+    explicit CsvWriter(int channels);
+    ~CsvWriter(void);
+
+    bool open(const QString &path, const QVector<ChannelScale> &scales, QString *error);
+    bool close(QString *error);
+    bool isOpen(void) const { return file.isOpen(); }
+
+    bool append(const int16_t *frames, const qint64 *timestamps, int count);
+    QString errorString(void) const { return file.errorString(); }
+
+private:
+    bool flush(void);
+
+    int channels;
+    QFile file;
+    QVector<ChannelScale> scales;
+    QByteArray buffer;
+};
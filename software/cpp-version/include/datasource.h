@@ -0,0 +1,54 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QThread>
+#include <cstdint>
+
+#include "samplestore.h"
+
+// Running counters of a source, totals since it was created. Sources fill in
+// what applies to them; readers may poll them from another thread.
+struct SourceStats {
+    qint64 bytes = 0;
+    qint64 parseErrors = 0;
+    qint64 droppedBytes = 0;
+    qint64 bufferedBytes = 0;
+    qint64 droppedFrames = 0;
+    qint64 queuedFrames = 0;
+};
+
+// Anything the acquisition pipeline can take frames from. readFrames() never
+// blocks: it decodes whatever the source has available, writing channelCount()
+// interleaved counts per frame together with a monotonic timestamp in
+// nanoseconds since the source was opened.
+class DataSource : public QObject {
+    Q_OBJECT
+
+public:
+    explicit DataSource(QObject *parent = nullptr) : QObject(parent) {}
+    virtual ~DataSource(void) {}
+
+    virtual QString name(void) const = 0;
+    virtual bool open(QString *error) = 0;
+    virtual void close(void) = 0;
+    virtual bool isOpen(void) const = 0;
+    virtual bool atEnd(void) const { return false; }
+    // A live source loses whatever isn't read in time. Others (replayed files)
+    // can be made to wait, so the pipeline holds them back instead of dropping.
+    virtual bool isLive(void) const { return true; }
+
+    virtual int channelCount(void) const = 0;
+    virtual ChannelScale scale(int channel) const { Q_UNUSED(channel); return ChannelScale(); }
+
+    virtual int readFrames(int16_t *frames, qint64 *timestamps, int maxFrames) = 0;
+    virtual SourceStats stats(void) const { return SourceStats(); }
+
+    // Used by reader threads to sleep until more input may be available.
+    virtual void waitForData(int msecs) { QThread::msleep(qMin(msecs, 1)); }
+
+    // Pausing releases the source by default; sources that can hold their
+    // position without the device (replays, generators) just stop the clock.
+    virtual void pause(void) { close(); }
+    virtual bool resume(QString *error) { return open(error); }
+};
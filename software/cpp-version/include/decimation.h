@@ -0,0 +1,26 @@
+#pragma once
+
+#include <QtGlobal>
+#include <cstdint>
+
+// One pixel column of a trace reduced to the four values that make the line
+// drawn through it pixel-exact: where it enters, its extremes and where it
+// leaves.
+struct ColumnM4 {
+    int16_t first;
+    int16_t min;
+    int16_t max;
+    int16_t last;
+};
+
+// Widens [*min, *max] to cover count raw samples. The vector width is picked
+// once at run time from the CPU (AVX2 or SSE2 on x86, NEON on ARM, plain C++
+// elsewhere); minMaxKernelName() reports which one is in use.
+void minMaxCounts(const int16_t *data, qint64 count, int16_t *min, int16_t *max);
+const char *minMaxKernelName(void);
+
+// The kernels this CPU can run, 0 being plain C++ and the last the one
+// minMaxCounts() uses; for comparing them.
+int minMaxKernelCount(void);
+const char *minMaxKernelName(int kernel);
+void minMaxCountsWith(int kernel, const int16_t *data, qint64 count, int16_t *min, int16_t *max);
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <QOpenGLWidget>
+#include <QOpenGLFunctions>
+#include <QOpenGLBuffer>
+#include <QOpenGLShaderProgram>
+#include <QVector>
+#include <QPointF>
+#include <QColor>
+#include <QRect>
+
+#define GL_TRACE_VIEW_MAX_LINE_WIDTH 8
+
+// Draws the plot's traces with OpenGL on top of a QCustomPlot, which keeps
+// painting the axes, grid and labels with QPainter. The view sits over the
+// axis rect as a transparent, always-on-top child that ignores the mouse, so
+// zooming and dragging still go to the plot underneath. Traces hand it their
+// pixel polylines while the plot replots (see StoreTrace::setGlView); all of
+// them go into one vertex buffer and each is drawn as a line strip.
+//
+// Only a GL 2.0 / GLES 2.0 context is needed, which Mesa's software
+// rasterizer (llvmpipe) also provides. If shaders cannot be built once the
+// widget gets its context, failed() is emitted and nothing is drawn; the
+// owner is expected to go back to QPainter.
+class GlTraceView : public QOpenGLWidget, protected QOpenGLFunctions {
+    Q_OBJECT
+
+public:
+    explicit GlTraceView(QWidget *parent = nullptr);
+    ~GlTraceView(void);
+
+    // Whether an OpenGL context can be created at all on this platform,
+    // checked with an offscreen surface before any window depends on it.
+    static bool isSupported(QString *error = nullptr);
+
+    bool hasFailed(void) const { return glFailed; }
+
+    // Called around each replot: the traces drawn in between replace the
+    // previous frame, whose pixel coordinates are relative to the plot and
+    // clipped to area.
+    void beginFrame(void);
+    void addTrace(const QVector<QPointF> &points, const QColor &color, double width);
+    void endFrame(const QRect &area);
+
+signals:
+    void failed(const QString &error);
+
+protected:
+    void initializeGL(void) override;
+    void paintGL(void) override;
+
+private:
+    struct Strip {
+        int first;
+        int count;
+        QColor color;
+        float width;
+    };
+
+    void releaseGl(void);
+    void fail(const QString &error);
+
+    QOpenGLShaderProgram *program;
+    QOpenGLBuffer vertexBuffer;
+    int positionLocation;
+    int projectionLocation;
+    int colorLocation;
+    bool glFailed;
+    bool uploadPending;
+    float lineWidthRange[2];
+
+    QVector<float> vertices;
+    QVector<Strip> strips;
+    QRect drawArea;
+};
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+
+#include "datasource.h"
+#include "sourcereader.h"
+#include "capturewriter.h"
+#include "csvwriter.h"
+#include "sampleserver.h"
+#ifdef Q_OS_UNIX
+#include "sharedringpublisher.h"
+#endif
+
+#define LOGGER_DRAIN_MS 10
+
+// Drives a source without any UI: a SourceReader thread decodes the input and
+// this object hands the frames to a capture or CSV file (chosen by extension),
+// optionally publishing them through a SampleServer or a shared-memory ring,
+// and printing throughput and drop counters at a fixed interval. It owns the
+// source, which must not have a parent.
+class HeadlessLogger : public QObject {
+    Q_OBJECT
+
+public:
+    explicit HeadlessLogger(DataSource *source, QObject *parent = nullptr);
+    ~HeadlessLogger(void);
+
+    void setServer(SampleServer *server) { this->server = server; }
+#ifdef Q_OS_UNIX
+    void setSharedRing(SharedRingPublisher *ring) { this->ring = ring; }
+#endif
+    bool start(const QString &path, qint64 durationMsecs, int statsMsecs, QString *error);
+    void stop(void);
+    bool hasFailed(void) const { return failed; }
+
+signals:
+    void finished(void);
+
+private slots:
+    void drain(void);
+    void printStats(void);
+
+private:
+    bool takeBlocks(void);
+    void fail(const QString &message);
+
+    DataSource *source;
+    SourceReader *reader;
+    CaptureWriter *captureWriter;
+    CsvWriter *csvWriter;
+    SampleServer *server;
+#ifdef Q_OS_UNIX
+    SharedRingPublisher *ring;
+#endif
+    FrameBlock block;
+
+    QElapsedTimer epoch;
+    QTimer drainTimer;
+    QTimer statsTimer;
+    qint64 duration;
+    qint64 frames;
+    qint64 statsFrames;
+    qint64 statsTime;
+    bool running;
+    bool failed;
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <QByteArray>
+#include <cstdint>
+
+#define PARSER_BUFFER_LIMIT 100000
+#define PARSER_READ_SIZE 16384
+
+// Decodes the firmware's text protocol: one frame per line, one integer count
+// per channel separated by tabs. Bytes are buffered until a full line arrives;
+// lines with the wrong number of fields are counted and skipped.
+//
+// The buffer is allocated once: callers read straight into the space returned
+// by reserve() and commit() what they got, and consumed bytes are reclaimed by
+// moving the unparsed tail back to the front only when the end is reached.
+class LineParser {
+public:
+    explicit LineParser(int channels);
+
+    char *reserve(int size);
+    void commit(int size);
+    void feed(const char *data, qint64 size);
+    int takeFrames(int16_t *frames, int maxFrames);
+    void reset(void);
+
+    qint64 parseErrors(void) const { return errors; }
+    qint64 droppedBytes(void) const { return dropped; }
+    qint64 bufferedBytes(void) const { return writePos - readPos; }
+
+private:
+    bool parseLine(const char *begin, const char *end, int16_t *frame) const;
+
+    int channels;
+    QByteArray buffer;
+    int readPos;
+    int writePos;
+    qint64 errors;
+    qint64 dropped;
+};
@@ -1,8 +1,6 @@
 #pragma once
 
 #include <QMainWindow>
-#include <QSerialPort>
-#include <QSerialPortInfo>
 #include <QTimer>
 #include <QVector>
 #include <QElapsedTimer>
@@ -10,68 +8,138 @@
 #include <QSlider>
 #include <QPushButton>
 #include <QComboBox>
+#include <QListWidget>
+#include <QGridLayout>
 #include <QGroupBox>
 #include <QMessageBox>
 
 #include "qcustomplot.h"
 #include "plotmanager.h"
+#include "samplestore.h"
+#include "capturewriter.h"
+#include "capturereplay.h"
+#include "acquisition.h"
+#include "sampleserver.h"
+#include "statsmonitor.h"
+#include "bauddetector.h"
+#include "portwatcher.h"
+#include "renderscheduler.h"
+#include "phosphor.h"
+#include "spectrogram.h"
 
 #define CHANNELS 4
+#define MULTI_MAX_PORTS (CAPTURE_MAX_CHANNELS / CHANNELS)
 #define MAX_PLOT_POINTS 1000
+#define MIN_PLOT_POINTS 10
+#define HISTORY_POINTS (1 << 25)
+#define SCALE_SLIDER_STEPS 1000
 
 class MainWindow : public QMainWindow {
     Q_OBJECT
 
 public:
+    enum SourceType { SourceSerial, SourceMultiSerial, SourceSynthetic, SourcePty };
+
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow(void);
 
+    PipelineStats pipelineStats(void) const { return statsMonitor->current(); }
+
 private slots:
     void updateScaleValue(int value);
     void autoPosition(void);
     void pauseResume(void);
     void clearPlot(void);
+    void toggleOpenGl(bool checked);
+    void openGlFailed(const QString &error);
+    void selectPersistence(int index);
+    void toggleSpectrogram(bool checked);
     void toggleChannel(int index, bool checked);
+    void selectSourceType(int index);
     void selectBaudRate(int index);
     void selectSerialPort(int index);
+    void baudDetectionFinished(void);
     void startAcquisition(void);
     void stopAcquisition(void);
+    void toggleRecording(bool checked);
+    void toggleSharing(bool checked);
+#ifdef Q_OS_UNIX
+    void toggleSharedMemory(bool checked);
+#endif
+    void openCapture(void);
+    void selectReplaySpeed(int index);
+    void seekReplay(void);
     void updatePlot(void);
+    void showStats(const PipelineStats &stats);
+    void updateSerialPorts(const QStringList &added, const QStringList &removed);
 
 private:
     void setupUi(void);
     void setupSerial(void);
-    void startSerialRead(void);
     void applyDarkMode(void);
     void updatePlotData(void);
-    void scanSerialPorts(void);
+    void createSinks(void);
+    void setChannelCount(int channels);
+    void buildChannelButtons(void);
+    QStringList checkedPorts(void) const;
+    qint64 visiblePoints(void) const;
+    void stopRecording(void);
+    void updateStartButton(void);
+    void detectBaudRate(void);
+    DataSource *createSource(void);
+    CaptureReplay *replaySource(void) const;
 
     QWidget *centralWidget;
     QCustomPlot *graphicsView;
+    QCustomPlot *spectrogramView;
     QLabel *scaleXLabel;
     QLabel *scaleXValueLabel;
     QSlider *scaleXSlider;
     QPushButton *autoPositionButton;
     QPushButton *pauseResumeButton;
     QPushButton *clearButton;
+    QPushButton *openGlButton;
+    QComboBox *persistenceModes;
+    QPushButton *spectrogramButton;
+    QPushButton *recordButton;
+    QPushButton *shareButton;
+#ifdef Q_OS_UNIX
+    QPushButton *sharedMemoryButton;
+    SharedRingPublisher sharedRing;
+#endif
+    QGridLayout *channelsGridLayout;
     QVector<QPushButton*> channelButtons;
+    QComboBox *sourceTypes;
     QComboBox *baudRates;
     QComboBox *serialPorts;
+    QListWidget *multiPorts;
+    QPushButton *openCaptureButton;
+    QComboBox *replaySpeeds;
+    QSlider *replayPosition;
     QPushButton *startButton;
     QPushButton *stopButton;
+    QLabel *statsLabel;
 
-    QSerialPort *serialPort;
-    QTimer *timer;
-    QTimer *serialScanTimer;
+    RenderScheduler *renderScheduler;
+    PortWatcher *portWatcher;
+    QString portName;
     int baudRate;
+    bool autoBaud;
+    int detectedChannels;
+    BaudDetector *baudDetector;
+    int channelCount;
     bool isAcquiring;
     bool isPaused;
-    QByteArray serialData;
 
-    QVector<QVector<double>> plotData;
-    QVector<double> xData;
+    SampleStore *sampleStore;
+    CaptureWriter *captureWriter;
+    Acquisition *acquisition;
+    SampleServer *sampleServer;
+    Phosphor *phosphor;
     QVector<QColor> colors;
-    QVector<QCPGraph*> plotDataItems;
+    QVector<StoreTrace*> plotDataItems;
     
     PlotManager *plotManager;
+    Spectrogram *spectrogram;
+    StatsMonitor *statsMonitor;
 };
\ No newline at end of file
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QVector>
+
+#include "datasource.h"
+#include "sourcereader.h"
+#include "clockmodel.h"
+
+#define MULTI_SOURCE_STALL_NS 500000000LL
+
+// Acquires from several sources at once, each on its own SourceReader thread,
+// and merges them into one frame stream whose channels are the concatenation
+// of the devices' channels. Device 0 sets the timeline: every other device has
+// a ClockModel (offset and drift against the host clock) fitted from its frame
+// counter, and is resampled at the nearest frame to each reference frame time.
+// A device that stops delivering for MULTI_SOURCE_STALL_NS is held at its last
+// value so the others keep flowing.
+class MultiSource : public DataSource {
+    Q_OBJECT
+
+public:
+    explicit MultiSource(QObject *parent = nullptr);
+    ~MultiSource(void);
+
+    void addSource(DataSource *source);
+    int sourceCount(void) const { return devices.size(); }
+    DataSource *sourceAt(int index) const { return devices[index].source; }
+    const ClockModel &clockModel(int index) const { return devices[index].clock; }
+
+    QString name(void) const override;
+    bool open(QString *error) override;
+    void close(void) override;
+    bool isOpen(void) const override { return opened; }
+
+    int channelCount(void) const override;
+    ChannelScale scale(int channel) const override;
+    int readFrames(int16_t *frames, qint64 *timestamps, int maxFrames) override;
+    SourceStats stats(void) const override;
+
+private:
+    struct Device {
+        DataSource *source;
+        SourceReader *reader;
+        int channels;
+        ClockModel clock;
+        FrameBlock block;
+        QVector<int16_t> staged;
+        int stagedHead;
+        qint64 stagedFirst;
+        qint64 received;
+        qint64 lastArrival;
+    };
+
+    void drain(Device &device);
+    const int16_t *stagedFrame(const Device &device, qint64 frame) const;
+    void discardBefore(Device &device, qint64 frame);
+
+    QVector<Device> devices;
+    QElapsedTimer epoch;
+    bool opened;
+    QVector<qint64> picks;
+};
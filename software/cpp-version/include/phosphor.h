@@ -0,0 +1,165 @@
+#pragma once
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QVector>
+#include <QQueue>
+#include <QAtomicInteger>
+#include <cstdint>
+
+#include "samplestore.h"
+
+#define PHOSPHOR_BLOCK_FRAMES 4096
+#define PHOSPHOR_POOL_BLOCKS 16
+#define PHOSPHOR_DECAY_MSECS 40
+#define PHOSPHOR_MAX_DECAY_STEPS 16
+#define PHOSPHOR_PUBLISH_MSECS 15
+
+// The cells a Phosphor counts hits in: columns spread over one sweep of
+// sweepLength samples, rows over the values [lower, upper) in scaled units,
+// row 0 being lower.
+struct PhosphorGeometry {
+    int columns = 0;
+    int rows = 0;
+    qint64 sweepLength = 0;
+    double lower = 0.0;
+    double upper = 1.0;
+
+    bool isValid(void) const { return columns > 0 && rows > 0 && sweepLength > 0 && upper > lower; }
+    bool operator==(const PhosphorGeometry &other) const {
+        return columns == other.columns && rows == other.rows && sweepLength == other.sweepLength && lower == other.lower && upper == other.upper;
+    }
+    bool operator!=(const PhosphorGeometry &other) const { return !(*this == other); }
+};
+
+// Digital phosphor: every sample of every channel is counted into a 2D hit
+// histogram per channel, indexed by its position in the current sweep and its
+// value, and the counts fade away over time, so a persistence view shows how
+// often the signal passed through each pixel. A sweep starts when the trigger
+// channel rises through the trigger level, or after a sweep's worth of samples
+// without one.
+//
+// Like CaptureWriter, publish() only copies frames into pooled blocks; a
+// background thread takes them from there, so it sees every sample at the full
+// acquisition rate whatever the display does. The sample values are turned
+// into rows with an integer SIMD kernel picked at run time (kernelName()) and
+// the counts saturate instead of wrapping. If every block is still queued the
+// frames are dropped and counted.
+//
+// The histogram belongs to the worker: it holds the mutex only to take a block
+// or a batch of setting changes and to give the block back, and applies the
+// changes between blocks. Every PHOSPHOR_PUBLISH_MSECS at most it copies the
+// counts to a front buffer that snapshot() reads under a lock of its own, so
+// neither acquisition nor painting ever waits for the histogram work.
+class Phosphor : public QThread {
+    Q_OBJECT
+
+public:
+    explicit Phosphor(QObject *parent = nullptr);
+    ~Phosphor(void);
+
+    void open(int channels);
+    void close(void);
+    bool isOpen(void) const { return opened; }
+
+    void setScales(const QVector<ChannelScale> &scales);
+    // Changing the geometry clears the counts.
+    void setGeometry(const PhosphorGeometry &geometry);
+    void setTrigger(int channel, double level);
+    // Every PHOSPHOR_DECAY_MSECS each count loses 1 / 2^shift of itself, and
+    // at least one; 0 keeps the counts forever.
+    void setDecay(int shift);
+    void clear(void);
+
+    void publish(const int16_t *frames, int count, int channels);
+
+    // Copies the counts last published, channel after channel, each columns x
+    // rows with the rows of a column next to each other.
+    bool snapshot(QVector<quint16> *hits, PhosphorGeometry *geometry, int *channels) const;
+
+    qint64 sweeps(void) const { return sweepCount.loadAcquire(); }
+    qint64 droppedFrames(void) const { return lostFrames.loadAcquire(); }
+    static const char *kernelName(void);
+
+protected:
+    void run(void) override;
+
+private:
+    struct Block {
+        int frames;
+        QVector<int16_t> samples;    // channel-major, PHOSPHOR_BLOCK_FRAMES per channel
+    };
+
+    // row = (raw * mul + add) >> shift
+    struct RowMapping {
+        int32_t mul;
+        int32_t add;
+        int shift;
+    };
+
+    struct Settings {
+        PhosphorGeometry geometry;
+        QVector<ChannelScale> scales;
+        int triggerChannel = 0;
+        double triggerLevel = 0.0;
+        int decayShift = 0;
+    };
+
+    enum Change {
+        GeometryChanged = 1,
+        ScalesChanged = 2,
+        TriggerChanged = 4,
+        DecayChanged = 8,
+        CountsCleared = 16
+    };
+
+    void submitCurrent(void);
+    void requestChange(int change);
+    void applySettings(const Settings &settings, int changed);
+    void publishCounts(void);
+    void updateMappings(void);
+    void accumulate(const Block *block);
+    int findTrigger(const Block *block, int from);
+    void accumulateRun(int channel, const int16_t *raw, int count);
+    void decay(int steps);
+
+    int channels;
+    bool opened;
+    QVector<Block*> pool;
+    Block *current;
+
+    QMutex mutex;
+    QWaitCondition blockReady;
+    QQueue<Block*> pending;
+    QVector<Block*> freeBlocks;
+    bool stopping;
+    Settings requested;
+    int changes;
+
+    // What snapshot() reads; the worker fills back and swaps it in.
+    mutable QMutex frontMutex;
+    QVector<quint16> front;
+    PhosphorGeometry frontGeometry;
+    QVector<quint16> back;
+
+    // Owned by the worker.
+    QVector<ChannelScale> scales;
+    PhosphorGeometry geometry;
+    QVector<RowMapping> mappings;
+    QVector<quint16> hits;
+    QVector<int32_t> rows;
+    quint64 columnStep;
+    qint64 position;
+    qint64 waited;
+    int triggerChannel;
+    double triggerLevel;
+    int32_t triggerRaw;
+    bool triggerRising;
+    int16_t previousTriggerSample;
+    bool havePrevious;
+    int decayShift;
+
+    QAtomicInteger<qint64> sweepCount;
+    QAtomicInteger<qint64> lostFrames;
+};
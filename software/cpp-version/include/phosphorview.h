@@ -0,0 +1,45 @@
+#pragma once
+
+#include <QVector>
+#include <QImage>
+#include <QColor>
+
+#include "qcustomplot.h"
+#include "phosphor.h"
+
+#define PHOSPHOR_VIEW_LEVELS 256
+
+// Shows a Phosphor's counts over the axis rect, colour graded like a
+// QCPColorMap: each channel gets a QCPColorGradient from a dim version of its
+// colour through the colour itself to white, indexed by the logarithm of a
+// cell's count against the busiest cell's, so a path the signal took once
+// stays visible next to one it takes every sweep. Where channels overlap their
+// light adds up. Cells are one pixel each while the phosphor's geometry
+// matches the axis rect; until it catches up with a resize the image is
+// stretched.
+class PhosphorView : public QCPLayerable {
+    Q_OBJECT
+
+public:
+    explicit PhosphorView(QCustomPlot *plot);
+
+    void setPhosphor(Phosphor *phosphor);
+    void setChannels(const QVector<QColor> &colors, const QVector<bool> &visible);
+
+protected:
+    void applyDefaultAntialiasingHint(QCPPainter *painter) const override;
+    QRect clipRect(void) const override;
+    void draw(QCPPainter *painter) override;
+
+private:
+    void buildPalettes(void);
+
+    Phosphor *phosphor;
+    QVector<QColor> colors;
+    QVector<bool> visible;
+    // Premultiplied, PHOSPHOR_VIEW_LEVELS per channel, level 0 transparent.
+    QVector<QVector<QRgb>> palettes;
+    QVector<quint16> hits;
+    QVector<uchar> levels;
+    QImage image;
+};
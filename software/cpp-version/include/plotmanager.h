@@ -5,6 +5,11 @@
 #include <QColor>
 
 #include "qcustomplot.h"
+#include "samplestore.h"
+#include "storetrace.h"
+#include "gltraceview.h"
+#include "traceraster.h"
+#include "phosphorview.h"
 
 class PlotManager : public QObject {
     Q_OBJECT
@@ -14,20 +19,80 @@ public:
     ~PlotManager(void);
 
     void setupPlot(void);
-    void updatePlotData(const QVector<QVector<double>> &data, const QVector<double> &xData, int currentLength, const QVector<bool> &channelVisibility);
+    void setChannelCount(int channels);
+    int getChannelCount(void) const { return channelCount; }
+    void updatePlotData(const SampleStore &store, qint64 currentLength, const QVector<bool> &channelVisibility);
     void clearPlot(void);
     void autoPosition(void);
+    // Sample index i is drawn at x = origin + i * period seconds; without a
+    // time base the X axis is in samples.
+    void setTimeBase(double origin, double period);
+    void clearTimeBase(void);
+    bool hasTimeBase(void) const { return timeBaseValid; }
+    void setFollowLive(bool follow) { followLive = follow; }
+    bool isFollowingLive(void) const { return followLive; }
     QVector<QColor> getColors(void) const { return colors; }
-    QVector<QCPGraph*> getPlotItems(void) const { return plotItems; }
+    QVector<StoreTrace*> getPlotItems(void) const { return plotItems; }
+    // Draws the traces with OpenGL over the plot instead of with QPainter.
+    // Fails when no context can be created; if the view fails later on,
+    // openGlFailed() is emitted and QPainter takes over again.
+    bool setOpenGl(bool enabled, QString *error = nullptr);
+    bool usesOpenGl(void) const { return glView != nullptr; }
+    // Shows the phosphor's persistence view in place of the traces, over one
+    // sweep of the visible length from the trigger on; nullptr goes back to
+    // the traces. The phosphor triggers on the first visible channel rising
+    // through the middle of the Y range.
+    void setPersistence(Phosphor *phosphor);
+    bool showsPersistence(void) const { return phosphor != nullptr; }
+    // Data replots so far and the total time spent in them.
+    qint64 replotCount(void) const { return replots; }
+    qint64 replotTime(void) const { return replotNsecs; }
+
+signals:
+    void viewRangeChanged(void);
+    void openGlFailed(const QString &error);
 
 public slots:
     void onXRangeChanged(const QCPRange &range);
     void onYRangeChanged(const QCPRange &range);
+    void onUserInteraction(void);
+
+private slots:
+    void beginGlFrame(void);
+    void endGlFrame(void);
+    void glViewFailed(const QString &error);
 
 private:
+    void createGraphs(void);
+    void attachRenderers(void);
+    void replotData(void);
+    void findTickPixels(void);
+    double xOf(double index) const { return timeBaseValid ? timeOrigin + index * timePeriod : index; }
+    double indexOf(double x) const { return timeBaseValid ? (x - timeOrigin) / timePeriod : x; }
+
     QCustomPlot *plot;
     int channelCount;
     int maxPlotPoints;
     QVector<QColor> colors;
-    QVector<QCPGraph*> plotItems;
+    QVector<StoreTrace*> plotItems;
+    QCPLayer *traceLayer;
+    TraceRaster *traceRaster;
+    PhosphorView *phosphorView;
+    Phosphor *phosphor;
+    // Where the grid lines and ticks last landed on screen and what the tick
+    // labels read; while that stays the same the grid and axes buffers are
+    // kept and only the trace layer is redrawn.
+    QVector<int> tickPixels;
+    QVector<int> drawnTickPixels;
+    QVector<QString> drawnTickLabels;
+    QRect drawnAxisRect;
+    QSize drawnSize;
+    bool staticLayersValid;
+    GlTraceView *glView;
+    bool followLive;
+    qint64 replots;
+    bool timeBaseValid;
+    double timeOrigin;
+    double timePeriod;
+    qint64 replotNsecs;
 };
\ No newline at end of file
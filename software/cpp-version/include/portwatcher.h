@@ -0,0 +1,48 @@
+#pragma once
+
+#include <QThread>
+#include <QStringList>
+#include <QAtomicInteger>
+
+#define PORT_WATCH_WAIT_MS 250
+#define PORT_WATCH_POLL_MS 1000
+#define PORT_WATCH_SETTLE_MS 200
+
+// Keeps track of the serial ports from a background thread so that
+// QSerialPortInfo::availablePorts() never runs on the GUI thread. On Linux the
+// port list is only rescanned when the kernel reports a tty being added or
+// removed (a NETLINK_KOBJECT_UEVENT socket, the same events udev listens to);
+// elsewhere, or if the socket cannot be opened, it is polled every
+// PORT_WATCH_POLL_MS. Only the differences are reported. While paused nothing
+// is scanned, events are just remembered for when it resumes, but a scan can
+// still be asked for explicitly.
+class PortWatcher : public QThread {
+    Q_OBJECT
+
+public:
+    explicit PortWatcher(QObject *parent = nullptr);
+    ~PortWatcher(void);
+
+    void stop(void);
+    void setPaused(bool paused);
+    void requestScan(void);
+
+    bool isEventDriven(void) const { return eventDriven.loadAcquire(); }
+
+signals:
+    void portsChanged(const QStringList &added, const QStringList &removed);
+
+protected:
+    void run(void) override;
+
+private:
+    int openEvents(void);
+    bool readEvents(int fd);
+    void scan(void);
+
+    QStringList known;
+    QAtomicInteger<int> stopRequested;
+    QAtomicInteger<int> pauseRequested;
+    QAtomicInteger<int> scanRequested;
+    QAtomicInteger<int> eventDriven;
+};
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "streamsource.h"
+
+// Opens a pseudo-terminal pair and reads the firmware protocol from its master
+// side. Anything that can talk to a serial device (a simulator, socat, a test
+// script) can write frames to slavePath() instead of a real board.
+class PtySource : public StreamSource {
+    Q_OBJECT
+
+public:
+    explicit PtySource(int channels, QObject *parent = nullptr);
+    ~PtySource(void);
+
+    QString name(void) const override { return slave; }
+    bool open(QString *error) override;
+    void close(void) override;
+    bool isOpen(void) const override { return masterFd >= 0; }
+    void pause(void) override {}
+    bool resume(QString *error) override { Q_UNUSED(error); return isOpen(); }
+    void waitForData(int msecs) override;
+
+    QString slavePath(void) const { return slave; }
+
+protected:
+    qint64 readBytes(char *data, qint64 maxSize) override;
+
+private:
+    int masterFd;
+    int slaveFd;
+    QString slave;
+};
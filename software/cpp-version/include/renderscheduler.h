@@ -0,0 +1,72 @@
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QVector>
+
+#define RENDER_DEFAULT_REFRESH_HZ 60
+#define RENDER_MAX_DIVISOR 6
+#define RENDER_BUDGET 0.5
+#define RENDER_HYSTERESIS 0.8
+#define RENDER_COST_SMOOTHING 0.1
+#define RENDER_HISTOGRAM_BUCKETS 6
+
+// Totals since the scheduler was created. histogram[i] counts the frames
+// shown at most bucketLimit(i) ms after the previous one (the last bucket has
+// no limit).
+struct RenderStats {
+    qint64 frames = 0;
+    qint64 coalesced = 0;        // requests merged into an already pending frame
+    double targetFps = 0.0;
+    double renderMsecs = 0.0;    // smoothed cost of one frame
+    QVector<qint64> histogram = QVector<qint64>(RENDER_HISTOGRAM_BUCKETS, 0);
+};
+
+// The only place that decides when the plot is redrawn. Anything that changes
+// what is on screen calls requestFrame(); requests made before the next frame
+// are merged into it. Frames start on the display's refresh grid, every
+// divisor-th refresh, where the divisor grows when a frame costs more than
+// RENDER_BUDGET of that interval (so the GUI thread keeps time for input) and
+// shrinks again once it comfortably fits. While running, poll() is emitted on
+// every refresh so new data can be collected and a frame requested; render()
+// is emitted to draw one.
+class RenderScheduler : public QObject {
+    Q_OBJECT
+
+public:
+    explicit RenderScheduler(QObject *parent = nullptr);
+
+    void start(void);
+    void stop(void);
+    bool isRunning(void) const { return running; }
+    void setRefreshRate(double hz);
+
+    void requestFrame(void);
+
+    double targetFps(void) const;
+    RenderStats stats(void) const;
+    static int bucketLimit(int bucket);
+
+signals:
+    void poll(void);
+    void render(void);
+
+private slots:
+    void tick(void);
+
+private:
+    void schedule(void);
+    void adapt(qint64 costNsecs);
+    void record(qint64 frameNsecs);
+
+    QTimer timer;
+    QElapsedTimer clock;
+    qint64 periodNsecs;
+    int divisor;
+    bool running;
+    bool pending;
+    qint64 lastFrame;
+    double smoothedCost;
+    RenderStats counters;
+};
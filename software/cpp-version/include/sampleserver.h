@@ -0,0 +1,61 @@
+#pragma once
+
+#include <QObject>
+#include <QVector>
+#include <QByteArray>
+#include <QIODevice>
+#include <cstdint>
+
+#include "samplestore.h"
+#include "serverformat.h"
+
+class QTcpServer;
+class QLocalServer;
+
+#define SERVER_QUEUE_BYTES (4 << 20)
+
+// Publishes decoded sample blocks to local clients over a Unix domain socket
+// (a named pipe on Windows) or a localhost TCP port, see serverformat.h. Each
+// client is fed through its socket's write buffer, capped at SERVER_QUEUE_BYTES:
+// a client that cannot keep up loses whole blocks, acquisition never waits.
+class SampleServer : public QObject {
+    Q_OBJECT
+
+public:
+    explicit SampleServer(QObject *parent = nullptr);
+    ~SampleServer(void);
+
+    // A plain number listens on that localhost TCP port, anything else is a
+    // local socket name.
+    bool listen(const QString &address, QString *error);
+    void close(void);
+    bool isListening(void) const { return tcpServer || localServer; }
+    QString address(void) const { return serverAddress; }
+
+    int subscriberCount(void) const { return subscribers.size(); }
+    qint64 droppedFrames(void) const { return dropped; }
+
+    void setScales(const QVector<ChannelScale> &scales);
+    void publish(const int16_t *frames, const qint64 *timestamps, int count, int channels);
+
+private slots:
+    void acceptConnections(void);
+    void removeSubscriber(void);
+
+private:
+    struct Subscriber {
+        QIODevice *socket;
+        quint32 pendingDrop;
+    };
+
+    void addSubscriber(QIODevice *socket);
+
+    QTcpServer *tcpServer;
+    QLocalServer *localServer;
+    QString serverAddress;
+    QVector<Subscriber> subscribers;
+    QByteArray hello;
+    QByteArray payload;
+    quint64 nextFrame;
+    qint64 dropped;
+};
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <QVector>
+#include <QString>
+#include <cstdint>
+
+#include "decimation.h"
+
+#define SAMPLE_BLOCK_SIZE 4096
+#define SAMPLE_BLOCK_ALIGNMENT 64
+#define PYRAMID_SHIFT 2
+#define PYRAMID_RAW_LEVEL 3
+
+struct ChannelScale {
+    double gain = 1.0;
+    double offset = 0.0;
+    QString unit;
+};
+
+// Columnar store of raw ADC counts: every channel keeps its samples as int16_t
+// in fixed-size aligned blocks which are reused as a ring once the capacity is
+// reached. Samples are addressed by their absolute index since the last clear,
+// conversion to doubles only happens for the requested window.
+//
+// Next to the raw samples every channel maintains a min/max pyramid where each
+// level aggregates 1 << PYRAMID_SHIFT buckets of the level below, so decimate()
+// and rangeMinMax() cost the same for a window of a thousand samples or of the
+// whole history. Both are exact: a range is answered with whole buckets from
+// the coarsest levels that fit and raw samples at its ragged ends, runs shorter
+// than PYRAMID_RAW_LEVEL's bucket being scanned with the SIMD min/max kernel;
+// the levels below it are not kept at all.
+class SampleStore {
+public:
+    SampleStore(int channels, qint64 capacity);
+    ~SampleStore(void);
+
+    SampleStore(const SampleStore &) = delete;
+    SampleStore &operator=(const SampleStore &) = delete;
+
+    int channelCount(void) const { return channels; }
+    qint64 capacity(void) const { return blockCount * SAMPLE_BLOCK_SIZE; }
+    qint64 firstIndex(void) const { return first; }
+    qint64 endIndex(void) const { return end; }
+    qint64 size(void) const { return end - first; }
+    bool isEmpty(void) const { return end == first; }
+
+    void append(const int16_t *frame);
+    void clear(void);
+
+    int16_t rawAt(int channel, qint64 index) const;
+    const int16_t *rawSpan(int channel, qint64 index, qint64 *available) const;
+
+    void setScale(int channel, const ChannelScale &scale);
+    const ChannelScale &scale(int channel) const { return scales[channel]; }
+
+    void toDouble(int channel, qint64 start, qint64 count, double *out) const;
+    void toDouble(int channel, qint64 start, qint64 count, QVector<double> &out) const;
+
+    // Column c covers samples [bounds[c], bounds[c + 1]), which must not be
+    // empty; bounds holds columns + 1 entries.
+    void decimate(int channel, const qint64 *bounds, int columns, ColumnM4 *out) const;
+    void rangeMinMax(int channel, qint64 lo, qint64 hi, int16_t *min, int16_t *max) const;
+
+private:
+    struct MinMax {
+        int16_t min;
+        int16_t max;
+    };
+
+    int16_t *blockFor(int channel, qint64 index);
+    void updatePyramid(int channel, qint64 index, int16_t value);
+    void rawMinMax(int channel, qint64 lo, qint64 hi, int16_t *min, int16_t *max) const;
+    void bucketMinMax(int channel, int level, qint64 lo, qint64 hi, int16_t *min, int16_t *max) const;
+
+    int channels;
+    qint64 blockCount;
+    qint64 first;
+    qint64 end;
+    QVector<QVector<int16_t*>> blocks;
+    QVector<ChannelScale> scales;
+    int levels;
+    QVector<qint64> levelSlots;
+    QVector<QVector<QVector<MinMax>>> pyramid;
+};
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <QSerialPort>
+
+#include "streamsource.h"
+
+class SerialSource : public StreamSource {
+    Q_OBJECT
+
+public:
+    SerialSource(const QString &portName, int baudRate, int channels, QObject *parent = nullptr);
+
+    QString name(void) const override { return port->portName(); }
+    bool open(QString *error) override;
+    void close(void) override;
+    bool isOpen(void) const override { return port->isOpen(); }
+    void waitForData(int msecs) override { port->waitForReadyRead(msecs); }
+
+    void setBaudRate(int baudRate);
+
+protected:
+    qint64 readBytes(char *data, qint64 maxSize) override;
+
+private:
+    QSerialPort *port;
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <QtGlobal>
+
+#include "captureformat.h"
+
+// Wire format of the live sample server (little-endian, naturally aligned):
+//
+//   ServerHello                        sent on connect and whenever the channel
+//                                      layout or calibration changes
+//   ServerBlockHeader + payload        repeated, payload is frames * qint64
+//                                      timestamps followed by frames * channels
+//                                      int16_t counts interleaved frame by frame
+//
+// firstFrame numbers frames since acquisition started; a jump means the client
+// fell behind and blocks were dropped for it (dropped says how many frames).
+
+#define SERVER_MAGIC "UASSRV01"
+#define SERVER_BLOCK_MAGIC 0x4b4c4253u // "SBLK"
+#define SERVER_VERSION 1
+#define SERVER_DEFAULT_NAME "uart-scope"
+
+struct ServerHello {
+    char magic[8];
+    quint32 version;
+    quint32 channels;
+    CaptureCalibration calibration[CAPTURE_MAX_CHANNELS];
+};
+
+struct ServerBlockHeader {
+    quint32 magic;
+    quint32 frames;
+    quint32 channels;
+    quint32 dropped;
+    quint64 firstFrame;
+};
+
+static_assert(sizeof(ServerHello) == 16 + CAPTURE_MAX_CHANNELS * 24, "unexpected padding in ServerHello");
+static_assert(sizeof(ServerBlockHeader) == 24, "unexpected padding in ServerBlockHeader");
@@ -0,0 +1,174 @@
+#pragma once
+
+/*
+ * Shared-memory sample ring published by uart-scope, and a header-only reader
+ * for other processes. Plain C99 or C++ on POSIX systems, no Qt required.
+ *
+ * Layout (native endianness, mapped from shm_open(name)):
+ *
+ *   SharedRingHeader                      at offset 0
+ *   int64_t timestamps[capacity]          at timestampOffset, nanoseconds
+ *   int16_t samples[capacity * channels]  at sampleOffset, interleaved counts
+ *
+ * Frame n lives in slot n & (capacity - 1). The publisher never waits for
+ * readers and uses two counters:
+ *
+ *   claimIndex  raised to n + count before frames [n, n + count) are written
+ *   writeIndex  raised to n + count once they are complete
+ *
+ * so frames below writeIndex are readable, and a frame read in place is only
+ * known to be intact if it is still at or above claimIndex - capacity after
+ * the read (a sequence-lock check, see sharedRingOldest()). Nothing on this
+ * path makes a system call.
+ *
+ * When the publisher stops, or restarts with a different channel layout, it
+ * sets closed and unlinks the segment; readers should unmap and open it again.
+ *
+ *   SharedRingReader ring;
+ *   if (sharedRingOpen(&ring, SHARED_RING_DEFAULT_NAME) == 0) {
+ *       uint64_t next = sharedRingWriteIndex(&ring);
+ *       while (!sharedRingClosed(&ring)) {
+ *           uint64_t count = sharedRingAvailable(&ring, &next);
+ *           const int16_t *frames = sharedRingFrame(&ring, next);
+ *           ... use count frames of ring.header->channels counts ...
+ *           if (sharedRingOldest(&ring) > next) { ... some were overwritten ... }
+ *           next += count;
+ *       }
+ *       sharedRingClose(&ring);
+ *   }
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define SHARED_RING_MAGIC "UASSHM01"
+#define SHARED_RING_VERSION 1
+#define SHARED_RING_MAX_CHANNELS 16
+#define SHARED_RING_DEFAULT_NAME "/uart-scope"
+#define SHARED_RING_DATA_ALIGN 4096
+
+typedef struct SharedRingCalibration {
+    double gain;
+    double offset;
+    char unit[8];
+} SharedRingCalibration;
+
+typedef struct SharedRingHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t channels;
+    uint64_t capacity;
+    uint64_t timestampOffset;
+    uint64_t sampleOffset;
+    uint64_t totalSize;
+    SharedRingCalibration calibration[SHARED_RING_MAX_CHANNELS];
+    uint8_t padding[16];
+
+    /* Publisher-owned counters, on their own cache line. */
+    uint64_t claimIndex;
+    uint64_t writeIndex;
+    uint32_t closed;
+    uint32_t reserved;
+} SharedRingHeader;
+
+#ifdef __cplusplus
+static_assert(offsetof(SharedRingHeader, claimIndex) % 64 == 0, "SharedRingHeader counters must start a cache line");
+static_assert(sizeof(SharedRingHeader) <= SHARED_RING_DATA_ALIGN, "SharedRingHeader must fit before the data");
+#endif
+
+typedef struct SharedRingReader {
+    const SharedRingHeader *header;
+    size_t size;
+    const int64_t *timestamps;
+    const int16_t *samples;
+    uint64_t mask;
+} SharedRingReader;
+
+/* Maps the segment read-only. Returns 0, or -1 with errno set. */
+static inline int sharedRingOpen(SharedRingReader *reader, const char *name) {
+    memset(reader, 0, sizeof(*reader));
+
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) {
+        return -1;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(SharedRingHeader)) {
+        close(fd);
+        return -1;
+    }
+
+    void *data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return -1;
+    }
+
+    const SharedRingHeader *header = (const SharedRingHeader *)data;
+    if (memcmp(header->magic, SHARED_RING_MAGIC, sizeof(header->magic)) != 0 || header->version != SHARED_RING_VERSION ||
+        header->totalSize > (uint64_t)info.st_size || header->capacity == 0 || (header->capacity & (header->capacity - 1)) != 0) {
+        munmap(data, (size_t)info.st_size);
+        return -1;
+    }
+
+    reader->header = header;
+    reader->size = (size_t)info.st_size;
+    reader->timestamps = (const int64_t *)((const char *)data + header->timestampOffset);
+    reader->samples = (const int16_t *)((const char *)data + header->sampleOffset);
+    reader->mask = header->capacity - 1;
+    return 0;
+}
+
+static inline void sharedRingClose(SharedRingReader *reader) {
+    if (reader->header) {
+        munmap((void *)reader->header, reader->size);
+    }
+    memset(reader, 0, sizeof(*reader));
+}
+
+static inline int sharedRingClosed(const SharedRingReader *reader) {
+    return __atomic_load_n(&reader->header->closed, __ATOMIC_ACQUIRE) != 0;
+}
+
+/* One past the newest complete frame. */
+static inline uint64_t sharedRingWriteIndex(const SharedRingReader *reader) {
+    return __atomic_load_n(&reader->header->writeIndex, __ATOMIC_ACQUIRE);
+}
+
+/* The oldest frame that has not been (and is not being) overwritten. Call it
+ * after reading frames in place: any of them below the result may be torn. */
+static inline uint64_t sharedRingOldest(const SharedRingReader *reader) {
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    uint64_t claimed = __atomic_load_n(&reader->header->claimIndex, __ATOMIC_RELAXED);
+    return claimed > reader->header->capacity ? claimed - reader->header->capacity : 0;
+}
+
+/* Number of complete frames from *frame that are contiguous in memory (up to
+ * the end of the ring). A *frame that has already been overwritten is moved
+ * forward to the oldest intact frame first. */
+static inline uint64_t sharedRingAvailable(const SharedRingReader *reader, uint64_t *frame) {
+    uint64_t end = sharedRingWriteIndex(reader);
+    uint64_t oldest = sharedRingOldest(reader);
+    if (*frame < oldest) {
+        *frame = oldest;
+    }
+    if (*frame >= end) {
+        return 0;
+    }
+    uint64_t contiguous = reader->header->capacity - (*frame & reader->mask);
+    return end - *frame < contiguous ? end - *frame : contiguous;
+}
+
+static inline const int16_t *sharedRingFrame(const SharedRingReader *reader, uint64_t frame) {
+    return reader->samples + (frame & reader->mask) * reader->header->channels;
+}
+
+static inline const int64_t *sharedRingTimestamps(const SharedRingReader *reader, uint64_t frame) {
+    return reader->timestamps + (frame & reader->mask);
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <QString>
+#include <QByteArray>
+#include <QVector>
+#include <cstdint>
+
+#include "samplestore.h"
+#include "sharedring.h"
+
+#define SHARED_RING_DEFAULT_FRAMES (1 << 20)
+
+// Writes decoded frames into a POSIX shared-memory ring (see sharedring.h) so
+// tools on the same machine can read them in place. Publishing is two memcpy
+// per segment and a pair of atomic stores; readers are never waited for.
+class SharedRingPublisher {
+public:
+    SharedRingPublisher(void);
+    ~SharedRingPublisher(void);
+
+    bool open(const QString &name, const QVector<ChannelScale> &scales, quint64 capacity, QString *error);
+    void close(void);
+    bool isOpen(void) const { return header != nullptr; }
+    QString name(void) const { return QString::fromLocal8Bit(segmentName); }
+
+    // Rewrites the calibration, or recreates the segment if the channel count
+    // changed (readers see closed and reopen).
+    bool setScales(const QVector<ChannelScale> &scales, QString *error);
+    void publish(const int16_t *frames, const qint64 *timestamps, int count, int channels);
+
+private:
+    void writeCalibration(const QVector<ChannelScale> &scales);
+
+    SharedRingHeader *header;
+    size_t size;
+    int64_t *timestamps;
+    int16_t *samples;
+    QByteArray segmentName;
+    quint64 capacity;
+};
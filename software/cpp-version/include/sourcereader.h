@@ -0,0 +1,71 @@
+#pragma once
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include <QVector>
+#include <QAtomicInteger>
+
+#include "datasource.h"
+
+#define READER_BATCH_FRAMES 1024
+#define READER_QUEUE_BLOCKS 256
+#define READER_QUEUE_FRAMES (READER_QUEUE_BLOCKS * READER_BATCH_FRAMES)
+#define READER_WAIT_MS 5
+
+struct FrameBlock {
+    int count = 0;
+    QVector<int16_t> frames;
+    QVector<qint64> timestamps;
+};
+
+// Runs one DataSource on a dedicated thread: the source is opened, read and
+// closed there, and decoded blocks are queued for the consumer with their
+// timestamps moved onto the shared epoch clock. The queue is bounded; if the
+// consumer falls behind, the newest blocks of a live source are dropped and
+// counted, while a source that isn't live (a replayed capture) waits for room
+// instead. A source that reaches its end stops the thread.
+//
+// The queue is a fixed ring of READER_QUEUE_BLOCKS slots and blocks are
+// handed over by swapping storage with a slot, never by copying: the consumer
+// gets the queued block and leaves its previous one behind for the reader to
+// refill. Once every slot has been used at full size the pipeline runs without
+// allocating.
+class SourceReader : public QThread {
+    Q_OBJECT
+
+public:
+    SourceReader(DataSource *source, const QElapsedTimer *epoch, QObject *parent = nullptr);
+    ~SourceReader(void);
+
+    bool open(QString *error);
+    void close(void);
+
+    bool takeBlock(FrameBlock &block);
+    bool atEnd(void);
+    qint64 droppedFrames(void) const { return dropped.loadAcquire(); }
+    int queuedFrameCount(void);
+
+protected:
+    void run(void) override;
+
+private:
+    DataSource *source;
+    QThread *owner;
+    const QElapsedTimer *epoch;
+
+    QMutex mutex;
+    QWaitCondition opened;
+    QWaitCondition spaceFree;
+    bool openDone;
+    bool openOk;
+    QString openError;
+    QAtomicInteger<int> stopRequested;
+
+    QVector<FrameBlock> ring;
+    int head;
+    int queuedBlocks;
+    int queuedFrames;
+    QAtomicInteger<qint64> dropped;
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <QObject>
+#include <QVector>
+#include <QColor>
+
+#include "qcustomplot.h"
+#include "samplestore.h"
+#include "spectrum.h"
+
+#define SPECTROGRAM_FFT_SIZE 512
+#define SPECTROGRAM_HISTORY_COLUMNS 1200
+#define SPECTROGRAM_COLUMN_SECONDS 0.1
+#define SPECTROGRAM_MAX_FRAMES 8
+#define SPECTROGRAM_MAX_COLUMNS 8
+#define SPECTROGRAM_DYNAMIC_RANGE_DB 90.0
+#define SPECTROGRAM_HEADROOM_DB 6.0
+
+// Waterfall of short-time spectra, one QCPColorMap per visible channel stacked
+// in a plot of its own: time runs along the X axis with the newest column at
+// 0, frequency up the Y axis. A column covers SPECTROGRAM_COLUMN_SECONDS of
+// samples, or SPECTROGRAM_MAX_FRAMES spectra's worth without a time base, and
+// holds the peak of up to SPECTROGRAM_MAX_FRAMES spectra spread over it, so
+// its cost doesn't grow with the sample rate and a burst between two of them
+// still shows. Each new column is written into the maps with
+// appendKeyColumn(), which colours just that column instead of rebuilding the
+// map image.
+//
+// update() computes the columns completed since the last call, at most
+// SPECTROGRAM_MAX_COLUMNS of them; older ones it didn't get to are left empty,
+// so the newest column always shows the latest samples.
+class Spectrogram : public QObject {
+    Q_OBJECT
+
+public:
+    explicit Spectrogram(QCustomPlot *plot, QObject *parent = nullptr);
+
+    void setChannels(int channels, const QVector<QColor> &colors);
+    // A period of 0 means the samples have no time base.
+    void update(const SampleStore &store, const QVector<bool> &channelVisibility, double period);
+    void clear(void);
+
+private:
+    struct Channel {
+        QCPAxisRect *rect;
+        QCPColorMap *map;
+        bool shown;
+    };
+
+    void removeChannels(void);
+    bool layoutChannels(const QVector<bool> &visible);
+    void setRanges(void);
+    void restart(void);
+    void appendColumn(const SampleStore &store, int channel, qint64 start);
+
+    QCustomPlot *plot;
+    QCPMarginGroup *marginGroup;
+    Spectrum spectrum;
+    QVector<Channel> channels;
+    QVector<bool> shownChannels;
+    qint64 nextIndex;
+    qint64 columnSamples;
+    double samplePeriod;
+    QVector<double> samples;
+    QVector<double> levels;
+    QVector<double> column;
+};
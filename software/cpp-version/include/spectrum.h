@@ -0,0 +1,30 @@
+#pragma once
+
+#include <QVector>
+#include <complex>
+
+#define SPECTRUM_FLOOR_DB -200.0
+
+// Short-time spectrum of a fixed power-of-two number of samples: the mean is
+// removed, a Hann window applied and a radix-2 FFT taken, with the twiddle
+// factors and the bit-reversed order computed once. Bin k is at k / size()
+// cycles per sample, for k up to size() / 2.
+class Spectrum {
+public:
+    explicit Spectrum(int size);
+
+    int size(void) const { return n; }
+    int bins(void) const { return n / 2 + 1; }
+
+    // Writes bins() levels in dB of the amplitude a sine at each bin would
+    // need, in the units of the samples; none is below SPECTRUM_FLOOR_DB.
+    void compute(const double *samples, double *decibels);
+
+private:
+    int n;
+    QVector<double> window;
+    double windowGain;
+    QVector<int> reversed;
+    QVector<std::complex<double>> twiddles;
+    QVector<std::complex<double>> buffer;
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+
+#include "acquisition.h"
+#include "plotmanager.h"
+#include "renderscheduler.h"
+
+#define STATS_INTERVAL_MS 1000
+
+// Pipeline health at a glance: totals since acquisition started, rates over the
+// last interval, and whether anything was lost during it.
+struct PipelineStats {
+    qint64 bytes = 0;
+    qint64 frames = 0;
+    qint64 parseErrors = 0;
+    qint64 droppedBytes = 0;
+    qint64 droppedFrames = 0;
+    qint64 bufferedBytes = 0;
+    qint64 queuedFrames = 0;
+
+    double bytesPerSecond = 0.0;
+    double framesPerSecond = 0.0;  // every frame carries one sample per channel
+    double renderFps = 0.0;
+    double targetFps = 0.0;        // what the render scheduler currently aims for
+    double replotMsecs = 0.0;      // average over the interval's replots
+    QVector<qint64> frameTimes;    // the interval's frames per RenderScheduler histogram bucket
+    bool saturated = false;        // data was dropped or rejected in the interval
+};
+
+// Samples the acquisition, the plot and the render scheduler once per interval
+// and publishes the resulting PipelineStats.
+class StatsMonitor : public QObject {
+    Q_OBJECT
+
+public:
+    StatsMonitor(Acquisition *acquisition, PlotManager *plotManager, RenderScheduler *scheduler, QObject *parent = nullptr);
+
+    void start(void);
+    void stop(void);
+    PipelineStats current(void) const { return stats; }
+
+signals:
+    void updated(const PipelineStats &stats);
+
+private slots:
+    void sample(void);
+
+private:
+    Acquisition *acquisition;
+    PlotManager *plotManager;
+    RenderScheduler *scheduler;
+    QTimer timer;
+    QElapsedTimer clock;
+    PipelineStats stats;
+    qint64 lastReplots;
+    qint64 lastReplotTime;
+    QVector<qint64> lastHistogram;
+};
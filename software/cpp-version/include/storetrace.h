@@ -0,0 +1,88 @@
+#pragma once
+
+#include <QVector>
+#include <QPointF>
+#include <cstdint>
+
+#include "qcustomplot.h"
+#include "samplestore.h"
+
+// Slack when rounding a column edge to a sample index, so an edge that lands
+// on a sample keeps it however the range's arithmetic rounds.
+#define STORE_TRACE_EDGE_EPSILON 1e-6
+
+class GlTraceView;
+
+// Working memory for StoreTrace::polyline(), kept from frame to frame so a
+// warm polyline allocates nothing.
+struct PolylineBuffers {
+    QVector<QPointF> points;
+    QVector<ColumnM4> columns;
+    QVector<qint64> bounds;
+};
+
+// Plots one channel of a SampleStore without copying it into the plot: the
+// trace only holds a pointer to the store and computes its pixel polyline when
+// QCustomPlot draws it. Windows that fit the axis rect's width are drawn sample
+// by sample, wider ones as the first, minimum, maximum and last sample of each
+// pixel column (M4), which draws the same pixels as the full line; the store
+// answers those from its pyramid, so the cost per frame follows the plot's
+// width and not the number of samples on screen. With a GlTraceView set the
+// polyline is handed to it instead of being painted, except for exports; a
+// rasterized trace is left to a TraceRaster, which paints it from its workers.
+class StoreTrace : public QCPAbstractPlottable {
+    Q_OBJECT
+
+public:
+    StoreTrace(QCPAxis *keyAxis, QCPAxis *valueAxis);
+
+    void setStore(const SampleStore *store, int channel);
+    const SampleStore *store(void) const { return sampleStore; }
+    int channel(void) const { return storeChannel; }
+
+    // Sample index i is drawn at key = origin + i * period.
+    void setTimeBase(double origin, double period);
+    void setGlView(GlTraceView *view) { glView = view; }
+    void setRasterized(bool enabled) { rasterized = enabled; }
+    bool isRasterized(void) const { return rasterized; }
+
+    // The pixel polyline over axis rect columns [firstColumn, lastColumn),
+    // plus the points just outside them so lines crossing the edges are
+    // complete, left in buffers->points. Only reads the store and the axes,
+    // so it may run on several threads at once with separate buffers while
+    // neither changes.
+    bool polyline(int firstColumn, int lastColumn, PolylineBuffers *buffers) const;
+    // Whether the visible window is drawn as M4 columns rather than sample
+    // by sample.
+    bool isDecimated(void) const;
+    // Sample index at the left edge of axis rect pixel column c. A column's
+    // M4 holds the samples from its left edge up to the next one's, so while
+    // the range keeps its size and moves by whole columns every column keeps
+    // its pixels.
+    double columnIndex(int column) const;
+    static void drawPolyline(QPainter *painter, const QVector<QPointF> &points, bool segments);
+
+    void clearData(void) override;
+    double selectTest(const QPointF &pos, bool onlySelectable, QVariant *details = 0) const override;
+
+protected:
+    void draw(QCPPainter *painter) override;
+    void drawLegendIcon(QCPPainter *painter, const QRectF &rect) const override;
+    QCPRange getKeyRange(bool &foundRange, SignDomain inSignDomain = sdBoth) const override;
+    QCPRange getValueRange(bool &foundRange, SignDomain inSignDomain = sdBoth) const override;
+
+private:
+    double keyOf(double index) const { return timeOrigin + index * timePeriod; }
+    double indexOf(double key) const { return (key - timeOrigin) / timePeriod; }
+    bool visibleSpan(qint64 *start, qint64 *stop) const;
+    void buildSamples(qint64 start, qint64 stop, QVector<QPointF> *out) const;
+    bool buildColumns(int firstColumn, int lastColumn, PolylineBuffers *buffers) const;
+
+    const SampleStore *sampleStore;
+    GlTraceView *glView;
+    bool rasterized;
+    int storeChannel;
+    double timeOrigin;
+    double timePeriod;
+    PolylineBuffers buffers;
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QAtomicInteger>
+
+#include "datasource.h"
+#include "lineparser.h"
+
+// Base for sources that deliver the firmware's byte stream (serial ports,
+// pseudo-terminals): subclasses only provide raw non-blocking reads and the
+// shared LineParser turns them into frames. Reads land directly in the
+// parser's buffer, so decoding a chunk costs no copy and no allocation.
+class StreamSource : public DataSource {
+    Q_OBJECT
+
+public:
+    StreamSource(int channels, QObject *parent = nullptr);
+
+    int channelCount(void) const override { return channels; }
+    int readFrames(int16_t *frames, qint64 *timestamps, int maxFrames) override;
+    SourceStats stats(void) const override;
+
+    const LineParser &lineParser(void) const { return parser; }
+
+protected:
+    virtual qint64 readBytes(char *data, qint64 maxSize) = 0;
+    void resetStream(void);
+
+private:
+    int channels;
+    LineParser parser;
+    QElapsedTimer clock;
+    qint64 lastReadTime;
+
+    QAtomicInteger<qint64> bytesRead;
+    QAtomicInteger<qint64> parseErrors;
+    QAtomicInteger<qint64> droppedBytes;
+    QAtomicInteger<qint64> bufferedBytes;
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QVector>
+#include <random>
+
+#include "datasource.h"
+
+#define SYNTHETIC_SAMPLE_RATE 1000.0
+#define SYNTHETIC_FULL_SCALE 1023
+
+// Generates waveforms at a fixed sample rate, paced by the host clock, so the
+// whole pipeline can run without a board attached. Glitches are single-sample
+// spikes to either rail injected at a configurable average rate.
+class SyntheticSource : public DataSource {
+    Q_OBJECT
+
+public:
+    enum Waveform { Sine, Square, Noise };
+
+    struct Channel {
+        Waveform waveform;
+        double frequency;
+        double amplitude;
+        double offset;
+    };
+
+    explicit SyntheticSource(int channels, double sampleRate = SYNTHETIC_SAMPLE_RATE, QObject *parent = nullptr);
+
+    QString name(void) const override { return "Synthetic"; }
+    bool open(QString *error) override;
+    void close(void) override { opened = false; }
+    bool isOpen(void) const override { return opened; }
+    void pause(void) override;
+    bool resume(QString *error) override;
+
+    int channelCount(void) const override { return generators.size(); }
+    int readFrames(int16_t *frames, qint64 *timestamps, int maxFrames) override;
+
+    void setChannel(int channel, const Channel &generator) { generators[channel] = generator; }
+    void setGlitchRate(double glitchesPerSecond) { glitchRate = glitchesPerSecond; }
+    double sampleRate(void) const { return rate; }
+
+private:
+    int16_t sample(const Channel &generator, double t);
+
+    QVector<Channel> generators;
+    double rate;
+    double glitchRate;
+    bool opened;
+    bool isPaused;
+    QElapsedTimer clock;
+    qint64 pausedAt;
+    qint64 pausedTotal;
+    qint64 generated;
+    std::mt19937 random;
+};
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <QVector>
+#include <QImage>
+#include <QPen>
+#include <QThreadPool>
+
+#include "qcustomplot.h"
+#include "storetrace.h"
+
+#define TRACE_RASTER_MIN_TILE_WIDTH 64
+// Columns past each side of a tile whose lines are drawn too, for the part of
+// a wide pen that spills over.
+#define TRACE_RASTER_EDGE_COLUMNS 2
+// How far from a whole number of columns the X range may have moved and still
+// be scrolled.
+#define TRACE_RASTER_SCROLL_SLACK 1e-3
+
+// Draws the plot's traces from a pool of worker threads. The axis rect is cut
+// into vertical tiles, one per thread, and each worker rasterizes every
+// trace's part of its tile into the tile's QImage; the GUI thread renders one
+// tile itself and then only draws the finished tiles onto the plot, so a
+// frame takes about as long as the busiest tile, whatever the number of
+// channels. The GUI thread waits for the workers within the frame since they
+// read the sample store, which it appends to between frames.
+//
+// Only the traces handed over that are marked rasterized are drawn; those skip
+// their own draw() except for exports, which the raster leaves to them.
+//
+// With scrolling on, as while the plot follows the live data, the last frame
+// is kept: when the X range only moved forward by whole pixel columns and
+// nothing else about the traces changed, the frame is shifted left in place
+// and only the columns from where the data used to end are rasterized, so a
+// frame costs what the new samples cost rather than the plot's width. Anything
+// else redraws the whole frame.
+class TraceRaster : public QCPLayerable {
+    Q_OBJECT
+
+public:
+    explicit TraceRaster(QCustomPlot *plot);
+    ~TraceRaster(void);
+
+    void setTraces(const QVector<StoreTrace*> &traces);
+    void setScrolling(bool enabled);
+    int threadCount(void) const { return pool.maxThreadCount() + 1; }
+
+protected:
+    void applyDefaultAntialiasingHint(QCPPainter *painter) const override;
+    QRect clipRect(void) const override;
+    void draw(QCPPainter *painter) override;
+
+private:
+    struct Layer {
+        const StoreTrace *trace;
+        QPen pen;
+        bool antialiased;
+        bool decimated;
+
+        bool operator==(const Layer &other) const {
+            return trace == other.trace && pen == other.pen && antialiased == other.antialiased && decimated == other.decimated;
+        }
+    };
+
+    struct Tile {
+        int firstColumn;
+        int lastColumn;
+        PolylineBuffers buffers;
+    };
+
+    class TileJob;
+
+    bool canScroll(int *shift, int *from) const;
+    void scroll(int shift);
+    void layoutTiles(int width);
+    void rasterize(Tile *tile);
+
+    QThreadPool pool;
+    QVector<StoreTrace*> traces;
+    QVector<Layer> layers;
+    QVector<Tile> tiles;
+    Tile strip;
+    QRect area;
+    bool segments;
+    // The whole axis rect; tiles paint into their columns of it.
+    QImage frame;
+    uchar *frameBits;
+    // What frame was drawn for, to tell whether it can be scrolled.
+    bool scrolling;
+    bool frameValid;
+    QVector<Layer> drawnLayers;
+    QCPRange drawnValueRange;
+    double drawnColumnIndex;
+    double drawnColumnSamples;
+    qint64 drawnEnd;
+};
@@ -708,6 +708,12 @@ void QCPScatterStyle::drawShape(QCPPainter *painter, double x, double y) const
   
   When a layer is deleted, the objects on it are not deleted with it, but fall on the layer below
   the deleted layer, see QCustomPlot::removeLayer.
+  
+  QCustomPlot keeps its rendered layers in one or more paint buffers and combines them on the
+  widget surface. Consecutive layers in mode \ref lmLogical share a buffer, while a layer in mode
+  \ref lmBuffered gets a buffer of its own (see \ref setMode). Such a layer can be redrawn with
+  \ref replot without repainting the layers below and above it, e.g. a layer holding frequently
+  changing graphs over a static grid and static axes.
 */
 
 /* start documentation of inline functions */
@@ -741,7 +747,9 @@ QCPLayer::QCPLayer(QCustomPlot *parentPlot, const QString &layerName) :
   mParentPlot(parentPlot),
   mName(layerName),
   mIndex(-1), // will be set to a proper value by the QCustomPlot layer creation function
-  mVisible(true)
+  mVisible(true),
+  mMode(lmLogical),
+  mPaintBufferIndex(0)
 {
   // Note: no need to make sure layerName is unique, because layer
   // management is done with QCustomPlot functions.
@@ -774,6 +782,64 @@ void QCPLayer::setVisible(bool visible)
   mVisible = visible;
 }
 
+/*!
+  Sets whether this layer is drawn into a paint buffer of its own (\ref lmBuffered) or shares one
+  with the neighbouring layers (\ref lmLogical, the default).
+  
+  Every buffered layer costs an extra pixmap of the widget's size and one more composition per
+  widget update, so only layers that are replotted on their own (see \ref replot) should be
+  buffered.
+*/
+void QCPLayer::setMode(QCPLayer::LayerMode mode)
+{
+  if (mMode != mode)
+  {
+    mMode = mode;
+    mParentPlot->mPaintBuffersValid = false;
+  }
+}
+
+/*!
+  Redraws the layerables of this layer. If the layer is in mode \ref lmBuffered, only its own paint
+  buffer is redrawn and combined with the unchanged buffers of the other layers. This is much
+  cheaper than a full \ref QCustomPlot::replot, but it's up to the caller to make sure nothing on
+  the other layers changed since the last replot, e.g. axis ranges (which change tick labels and
+  grid lines) or the layout.
+  
+  Layers in mode \ref lmLogical, as well as buffered layers whose buffers aren't valid yet (e.g.
+  after a resize or a change of the layer setup), cause a full \ref QCustomPlot::replot.
+  
+  The signals \ref QCustomPlot::beforeReplot and \ref QCustomPlot::afterReplot are emitted either
+  way.
+*/
+void QCPLayer::replot()
+{
+  if (mMode == lmBuffered && mParentPlot->mPaintBuffersValid)
+    mParentPlot->replotLayer(this);
+  else
+    mParentPlot->replot();
+}
+
+/*! \internal
+  
+  Draws the visible layerables of this layer with \a painter, each clipped to its \ref
+  QCPLayerable::clipRect.
+*/
+void QCPLayer::draw(QCPPainter *painter)
+{
+  foreach (QCPLayerable *child, mChildren)
+  {
+    if (child->realVisibility())
+    {
+      painter->save();
+      painter->setClipRect(child->clipRect().translated(0, -1));
+      child->applyDefaultAntialiasingHint(painter);
+      child->draw(painter);
+      painter->restore();
+    }
+  }
+}
+
 /*! \internal
   
   Adds the \a layerable to the list of this layer. If \a prepend is set to true, the layerable will
@@ -9034,7 +9100,7 @@ QCustomPlot::QCustomPlot(QWidget *parent) :
   mCurrentLayer(0),
   mPlottingHints(QCP::phCacheLabels|QCP::phForceRepaint),
   mMultiSelectModifier(Qt::ControlModifier),
-  mPaintBuffer(size()),
+  mPaintBuffersValid(false),
   mMouseEventElement(0),
   mReplotting(false)
 {
@@ -10098,6 +10164,7 @@ bool QCustomPlot::addLayer(const QString &name, QCPLayer *otherLayer, QCustomPlo
   QCPLayer *newLayer = new QCPLayer(this, name);
   mLayers.insert(otherLayer->index() + (insertMode==limAbove ? 1:0), newLayer);
   updateLayerIndices();
+  mPaintBuffersValid = false;
   return true;
 }
 
@@ -10149,6 +10216,7 @@ bool QCustomPlot::removeLayer(QCPLayer *layer)
   delete layer;
   mLayers.removeOne(layer);
   updateLayerIndices();
+  mPaintBuffersValid = false;
   return true;
 }
 
@@ -10180,6 +10248,7 @@ bool QCustomPlot::moveLayer(QCPLayer *layer, QCPLayer *otherLayer, QCustomPlot::
     mLayers.move(layer->index(), otherLayer->index() + (insertMode==limAbove ? 0:-1));
   
   updateLayerIndices();
+  mPaintBuffersValid = false;
   return true;
 }
 
@@ -10351,9 +10420,11 @@ void QCustomPlot::deselectAll()
 }
 
 /*!
-  Causes a complete replot into the internal buffer. Finally, update() is called, to redraw the
-  buffer on the QCustomPlot widget surface. This is the method that must be called to make changes,
-  for example on the axis ranges or data points of graphs, visible.
+  Causes a complete replot into the internal paint buffers. Finally, update() is called, to redraw
+  the buffers on the QCustomPlot widget surface. This is the method that must be called to make
+  changes, for example on the axis ranges or data points of graphs, visible. If only the
+  layerables on a layer in mode \ref QCPLayer::lmBuffered changed, \ref QCPLayer::replot is
+  cheaper.
   
   Under a few circumstances, QCustomPlot causes a replot by itself. Those are resize events of the
   QCustomPlot widget and user interactions (object selection and range dragging/zooming).
@@ -10370,22 +10441,45 @@ void QCustomPlot::replot(QCustomPlot::RefreshPriority refreshPriority)
   mReplotting = true;
   emit beforeReplot();
   
-  mPaintBuffer.fill(mBackgroundBrush.style() == Qt::SolidPattern ? mBackgroundBrush.color() : Qt::transparent);
-  QCPPainter painter;
-  painter.begin(&mPaintBuffer);
-  if (painter.isActive())
+  updateLayout();
+  setupPaintBuffers();
+  bool painted = true;
+  for (int i=0; i<mPaintBuffers.size(); ++i)
+    painted = drawPaintBuffer(i) && painted;
+  mPaintBuffersValid = painted;
+  if (painted)
   {
-    painter.setRenderHint(QPainter::HighQualityAntialiasing); // to make Antialiasing look good if using the OpenGL graphicssystem
-    if (mBackgroundBrush.style() != Qt::SolidPattern && mBackgroundBrush.style() != Qt::NoBrush)
-      painter.fillRect(mViewport, mBackgroundBrush);
-    draw(&painter);
-    painter.end();
     if ((refreshPriority == rpHint && mPlottingHints.testFlag(QCP::phForceRepaint)) || refreshPriority==rpImmediate)
       repaint();
     else
       update();
-  } else // might happen if QCustomPlot has width or height zero
-    qDebug() << Q_FUNC_INFO << "Couldn't activate painter on buffer. This usually happens because QCustomPlot has width or height zero.";
+  }
+  
+  emit afterReplot();
+  mReplotting = false;
+}
+
+/*! \internal
+  
+  Redraws only the paint buffer of the buffered \a layer and schedules a widget update, which
+  combines it with the unchanged buffers of the other layers. Called by \ref QCPLayer::replot,
+  which makes sure the buffers are valid. The layout isn't updated either, so this is only correct
+  if nothing but the layerables on \a layer changed since the last full \ref replot.
+*/
+void QCustomPlot::replotLayer(QCPLayer *layer)
+{
+  if (mReplotting) // incase signals loop back to replot slot
+    return;
+  mReplotting = true;
+  emit beforeReplot();
+  
+  if (drawPaintBuffer(layer->mPaintBufferIndex))
+  {
+    if (mPlottingHints.testFlag(QCP::phForceRepaint))
+      repaint();
+    else
+      update();
+  }
   
   emit afterReplot();
   mReplotting = false;
@@ -10658,19 +10752,21 @@ void QCustomPlot::paintEvent(QPaintEvent *event)
 {
   Q_UNUSED(event);
   QPainter painter(this);
-  painter.drawPixmap(0, 0, mPaintBuffer);
+  for (int i=0; i<mPaintBuffers.size(); ++i)
+    painter.drawPixmap(0, 0, mPaintBuffers.at(i));
 }
 
 /*! \internal
   
-  Event handler for a resize of the QCustomPlot widget. Causes the internal buffer to be resized to
-  the new size. The viewport (which becomes the outer rect of mPlotLayout) is resized
-  appropriately. Finally a \ref replot is performed.
+  Event handler for a resize of the QCustomPlot widget. Invalidates the internal paint buffers, which
+  are reallocated with the new size on the next \ref replot. The viewport (which becomes the outer
+  rect of mPlotLayout) is resized appropriately. Finally a \ref replot is performed.
 */
 void QCustomPlot::resizeEvent(QResizeEvent *event)
 {
-  // resize and repaint the buffer:
-  mPaintBuffer = QPixmap(event->size());
+  Q_UNUSED(event);
+  // resize and repaint the buffers:
+  mPaintBuffersValid = false;
   setViewport(rect());
   replot(rpQueued); // queued update is important here, to prevent painting issues in some contexts
 }
@@ -10873,29 +10969,14 @@ void QCustomPlot::wheelEvent(QWheelEvent *event)
 */
 void QCustomPlot::draw(QCPPainter *painter)
 {
-  // run through layout phases:
-  mPlotLayout->update(QCPLayoutElement::upPreparation);
-  mPlotLayout->update(QCPLayoutElement::upMargins);
-  mPlotLayout->update(QCPLayoutElement::upLayout);
+  updateLayout();
   
   // draw viewport background pixmap:
   drawBackground(painter);
 
   // draw all layered objects (grid, axes, plottables, items, legend,...):
   foreach (QCPLayer *layer, mLayers)
-  {
-    foreach (QCPLayerable *child, layer->children())
-    {
-      if (child->realVisibility())
-      {
-        painter->save();
-        painter->setClipRect(child->clipRect().translated(0, -1));
-        child->applyDefaultAntialiasingHint(painter);
-        child->draw(painter);
-        painter->restore();
-      }
-    }
-  }
+    layer->draw(painter);
   
   /* Debug code to draw all layout element rects
   foreach (QCPLayoutElement* el, findChildren<QCPLayoutElement*>())
@@ -10949,6 +11030,87 @@ void QCustomPlot::drawBackground(QCPPainter *painter)
 }
 
 
+/*!
+  Runs through the layout phases of the plot layout, so margins, axis rects, tick vectors and
+  tick labels are up to date before anything is drawn. \ref replot does this itself; calling it
+  beforehand lets the caller see where the ticks will land (see \ref QCPAxis::tickVector) and,
+  if nothing on the static layers changed, redraw only a buffered layer with \ref
+  QCPLayer::replot.
+*/
+void QCustomPlot::updateLayout()
+{
+  mPlotLayout->update(QCPLayoutElement::upPreparation);
+  mPlotLayout->update(QCPLayoutElement::upMargins);
+  mPlotLayout->update(QCPLayoutElement::upLayout);
+}
+
+/*! \internal
+  
+  Assigns the layers to paint buffers, bottom to top: consecutive layers in mode \ref
+  QCPLayer::lmLogical share one buffer, and a layer in mode \ref QCPLayer::lmBuffered gets one of
+  its own. Buffers are (re)allocated to match the widget size.
+*/
+void QCustomPlot::setupPaintBuffers()
+{
+  int bufferIndex = 0;
+  bool previousBuffered = false;
+  for (int i=0; i<mLayers.size(); ++i)
+  {
+    QCPLayer *layer = mLayers.at(i);
+    bool buffered = layer->mode() == QCPLayer::lmBuffered;
+    if (i > 0 && (buffered || previousBuffered))
+      ++bufferIndex;
+    layer->mPaintBufferIndex = bufferIndex;
+    previousBuffered = buffered;
+  }
+  
+  while (mPaintBuffers.size() > bufferIndex+1)
+    mPaintBuffers.removeLast();
+  while (mPaintBuffers.size() < bufferIndex+1)
+    mPaintBuffers.append(QPixmap());
+  for (int i=0; i<mPaintBuffers.size(); ++i)
+  {
+    if (mPaintBuffers.at(i).size() != size())
+      mPaintBuffers[i] = QPixmap(size());
+  }
+}
+
+/*! \internal
+  
+  Clears the paint buffer with the given \a index and draws the layers assigned to it. The bottom
+  buffer also gets the plot background, all others stay transparent where nothing is drawn, so
+  they can be laid over it in \ref paintEvent.
+  
+  Returns false if the buffer couldn't be painted on.
+*/
+bool QCustomPlot::drawPaintBuffer(int index)
+{
+  QPixmap &buffer = mPaintBuffers[index];
+  buffer.fill(index == 0 && mBackgroundBrush.style() == Qt::SolidPattern ? mBackgroundBrush.color() : Qt::transparent);
+  QCPPainter painter;
+  painter.begin(&buffer);
+  if (!painter.isActive()) // might happen if QCustomPlot has width or height zero
+  {
+    qDebug() << Q_FUNC_INFO << "Couldn't activate painter on buffer. This usually happens because QCustomPlot has width or height zero.";
+    return false;
+  }
+  
+  painter.setRenderHint(QPainter::HighQualityAntialiasing); // to make Antialiasing look good if using the OpenGL graphicssystem
+  if (index == 0)
+  {
+    if (mBackgroundBrush.style() != Qt::SolidPattern && mBackgroundBrush.style() != Qt::NoBrush)
+      painter.fillRect(mViewport, mBackgroundBrush);
+    drawBackground(&painter);
+  }
+  foreach (QCPLayer *layer, mLayers)
+  {
+    if (layer->mPaintBufferIndex == index)
+      layer->draw(&painter);
+  }
+  painter.end();
+  return true;
+}
+
 /*! \internal
   
   This method is used by \ref QCPAxisRect::removeAxis to report removed axes to the QCustomPlot
@@ -14542,6 +14704,7 @@ void QCPGraph::setData(const QVector<double> &key, const QVector<double> &value)
   mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
+  mData->reserve(n);
   QCPData newData;
   for (int i=0; i<n; ++i)
   {
@@ -14919,9 +15082,7 @@ void QCPGraph::addData(const QVector<double> &keys, const QVector<double> &value
 */
 void QCPGraph::removeDataBefore(double key)
 {
-  QCPDataMap::iterator it = mData->begin();
-  while (it != mData->end() && it.key() < key)
-    it = mData->erase(it);
+  mData->erase(mData->begin(), mData->lowerBound(key));
 }
 
 /*!
@@ -14931,9 +15092,7 @@ void QCPGraph::removeDataBefore(double key)
 void QCPGraph::removeDataAfter(double key)
 {
   if (mData->isEmpty()) return;
-  QCPDataMap::iterator it = mData->upperBound(key);
-  while (it != mData->end())
-    it = mData->erase(it);
+  mData->erase(mData->upperBound(key), mData->end());
 }
 
 /*!
@@ -14946,10 +15105,7 @@ void QCPGraph::removeDataAfter(double key)
 void QCPGraph::removeData(double fromKey, double toKey)
 {
   if (fromKey >= toKey || mData->isEmpty()) return;
-  QCPDataMap::iterator it = mData->upperBound(fromKey);
-  QCPDataMap::iterator itEnd = mData->upperBound(toKey);
-  while (it != itEnd)
-    it = mData->erase(it);
+  mData->erase(mData->upperBound(fromKey), mData->upperBound(toKey));
 }
 
 /*! \overload
@@ -15991,14 +16147,7 @@ int QCPGraph::countDataInBounds(const QCPDataMap::const_iterator &lower, const Q
 {
   if (upper == mData->constEnd() && lower == mData->constEnd())
     return 0;
-  QCPDataMap::const_iterator it = lower;
-  int count = 1;
-  while (it != upper && count < maxCount)
-  {
-    ++it;
-    ++count;
-  }
-  return count;
+  return qMin<int>(upper-lower+1, maxCount);
 }
 
 /*! \internal
@@ -16997,9 +17146,7 @@ void QCPCurve::addData(const QVector<double> &ts, const QVector<double> &keys, c
 */
 void QCPCurve::removeDataBefore(double t)
 {
-  QCPCurveDataMap::iterator it = mData->begin();
-  while (it != mData->end() && it.key() < t)
-    it = mData->erase(it);
+  mData->erase(mData->begin(), mData->lowerBound(t));
 }
 
 /*!
@@ -17009,9 +17156,7 @@ void QCPCurve::removeDataBefore(double t)
 void QCPCurve::removeDataAfter(double t)
 {
   if (mData->isEmpty()) return;
-  QCPCurveDataMap::iterator it = mData->upperBound(t);
-  while (it != mData->end())
-    it = mData->erase(it);
+  mData->erase(mData->upperBound(t), mData->end());
 }
 
 /*!
@@ -17024,10 +17169,7 @@ void QCPCurve::removeDataAfter(double t)
 void QCPCurve::removeData(double fromt, double tot)
 {
   if (fromt >= tot || mData->isEmpty()) return;
-  QCPCurveDataMap::iterator it = mData->upperBound(fromt);
-  QCPCurveDataMap::iterator itEnd = mData->upperBound(tot);
-  while (it != itEnd)
-    it = mData->erase(it);
+  mData->erase(mData->upperBound(fromt), mData->upperBound(tot));
 }
 
 /*! \overload
@@ -18701,9 +18843,7 @@ void QCPBars::addData(const QVector<double> &keys, const QVector<double> &values
 */
 void QCPBars::removeDataBefore(double key)
 {
-  QCPBarDataMap::iterator it = mData->begin();
-  while (it != mData->end() && it.key() < key)
-    it = mData->erase(it);
+  mData->erase(mData->begin(), mData->lowerBound(key));
 }
 
 /*!
@@ -18713,9 +18853,7 @@ void QCPBars::removeDataBefore(double key)
 void QCPBars::removeDataAfter(double key)
 {
   if (mData->isEmpty()) return;
-  QCPBarDataMap::iterator it = mData->upperBound(key);
-  while (it != mData->end())
-    it = mData->erase(it);
+  mData->erase(mData->upperBound(key), mData->end());
 }
 
 /*!
@@ -18728,10 +18866,7 @@ void QCPBars::removeDataAfter(double key)
 void QCPBars::removeData(double fromKey, double toKey)
 {
   if (fromKey >= toKey || mData->isEmpty()) return;
-  QCPBarDataMap::iterator it = mData->upperBound(fromKey);
-  QCPBarDataMap::iterator itEnd = mData->upperBound(toKey);
-  while (it != itEnd)
-    it = mData->erase(it);
+  mData->erase(mData->upperBound(fromKey), mData->upperBound(toKey));
 }
 
 /*! \overload
@@ -20043,6 +20178,14 @@ void QCPColorMapData::cellToCoord(int keyIndex, int valueIndex, double *key, dou
   \see setData
 */
 
+/*! \fn int QCPColorMap::keyRingHead() const
+  
+  Returns the key index of the cell column the next call to \ref appendKeyColumn will write, which
+  is also the oldest column once the map has been filled that way.
+  
+  \see appendKeyColumn
+*/
+
 /* end documentation of inline functions */
 
 /* start documentation of signals */
@@ -20082,7 +20225,8 @@ QCPColorMap::QCPColorMap(QCPAxis *keyAxis, QCPAxis *valueAxis) :
   mMapData(new QCPColorMapData(10, 10, QCPRange(0, 5), QCPRange(0, 5))),
   mInterpolate(true),
   mTightBoundary(false),
-  mMapImageInvalidated(true)
+  mMapImageInvalidated(true),
+  mKeyRingHead(0)
 {
 }
 
@@ -20114,6 +20258,7 @@ void QCPColorMap::setData(QCPColorMapData *data, bool copy)
     mMapData = data;
   }
   mMapImageInvalidated = true;
+  mKeyRingHead = 0;
 }
 
 /*!
@@ -20305,6 +20450,50 @@ void QCPColorMap::updateLegendIcon(Qt::TransformationMode transformMode, const Q
 void QCPColorMap::clearData()
 {
   mMapData->clear();
+  mKeyRingHead = 0;
+}
+
+/*!
+  Writes the \ref QCPColorMapData::valueSize values in \a values to the cell column at \ref
+  keyRingHead and advances the head by one, wrapping around at the key size. The map is drawn
+  starting with the column at the head, so each call scrolls the map by one column along the key
+  axis and shows \a values at its upper key end, like a waterfall display.
+  
+  Unlike setting the cells through \ref QCPColorMapData, this doesn't regenerate the whole map
+  image on the next replot: if the image is up to date and not oversampled (see \ref
+  setInterpolate), only the pixels of the written column are colorized. The cells keep their ring
+  order in the data, i.e. \ref QCPColorMapData::cell for key index 0 isn't the oldest column
+  unless \ref keyRingHead is 0, and the data bounds aren't updated.
+*/
+void QCPColorMap::appendKeyColumn(const double *values)
+{
+  QCPAxis *keyAxis = mKeyAxis.data();
+  if (!keyAxis || mMapData->isEmpty()) return;
+  
+  const int keySize = mMapData->keySize();
+  const int valueSize = mMapData->valueSize();
+  if (mKeyRingHead >= keySize)
+    mKeyRingHead = 0;
+  double *column = mMapData->mData+mKeyRingHead;
+  for (int i=0; i<valueSize; ++i)
+    column[i*keySize] = values[i];
+  
+  // colorize just this column if the image is otherwise current and has one pixel per cell:
+  if (!mMapData->mDataModified && !mMapImageInvalidated)
+  {
+    const bool logarithmic = mDataScaleType==QCPAxis::stLogarithmic;
+    if (keyAxis->orientation() == Qt::Horizontal && mMapImage.width() == keySize && mMapImage.height() == valueSize)
+    {
+      for (int line=0; line<valueSize; ++line)
+        reinterpret_cast<QRgb*>(mMapImage.scanLine(valueSize-1-line))[mKeyRingHead] = mGradient.color(values[line], mDataRange, logarithmic);
+    } else if (keyAxis->orientation() == Qt::Vertical && mMapImage.width() == valueSize && mMapImage.height() == keySize)
+    {
+      QRgb* pixels = reinterpret_cast<QRgb*>(mMapImage.scanLine(keySize-1-mKeyRingHead));
+      mGradient.colorize(values, mDataRange, pixels, valueSize, 1, logarithmic);
+    } else
+      mMapImageInvalidated = true;
+  }
+  mKeyRingHead = (mKeyRingHead+1) % keySize;
 }
 
 /* inherits documentation from base class */
@@ -20400,6 +20589,44 @@ void QCPColorMap::updateMapImage()
   mMapImageInvalidated = false;
 }
 
+/*! \internal
+  
+  Returns the map image with its key columns rotated such that the one at \ref keyRingHead comes
+  first. If the head is at 0, this is the map image itself, otherwise the rotation is copied into a
+  buffer that is kept between replots.
+*/
+const QImage &QCPColorMap::ringOrderedMapImage()
+{
+  if (mKeyRingHead == 0 || mMapData->keySize() < 2 || mMapImage.isNull())
+    return mMapImage;
+  if (mRingImage.size() != mMapImage.size() || mRingImage.format() != mMapImage.format())
+    mRingImage = QImage(mMapImage.size(), mMapImage.format());
+  
+  const int bytesPerLine = mMapImage.bytesPerLine();
+  if (keyAxis()->orientation() == Qt::Horizontal)
+  {
+    // pixel columns are keys from left to right, the head column moves to the left edge:
+    const int pixelBytes = mMapImage.depth()/8;
+    const int shift = mKeyRingHead*(mMapImage.width()/mMapData->keySize())*pixelBytes;
+    const int rowBytes = mMapImage.width()*pixelBytes;
+    for (int y=0; y<mMapImage.height(); ++y)
+    {
+      const uchar *source = mMapImage.constScanLine(y);
+      uchar *target = mRingImage.scanLine(y);
+      memcpy(target, source+shift, rowBytes-shift);
+      memcpy(target+rowBytes-shift, source, shift);
+    }
+  } else
+  {
+    // scanlines are keys from bottom to top, the head scanline moves to the bottom edge:
+    const int shift = mKeyRingHead*(mMapImage.height()/mMapData->keySize());
+    const int height = mMapImage.height();
+    for (int y=0; y<height; ++y)
+      memcpy(mRingImage.scanLine((y+shift) % height), mMapImage.constScanLine(y), bytesPerLine);
+  }
+  return mRingImage;
+}
+
 /* inherits documentation from base class */
 void QCPColorMap::draw(QCPPainter *painter)
 {
@@ -20457,7 +20684,7 @@ void QCPColorMap::draw(QCPPainter *painter)
                                   coordsToPixels(mMapData->keyRange().upper, mMapData->valueRange().upper)).normalized();
     localPainter->setClipRect(tightClipRect, Qt::IntersectClip);
   }
-  localPainter->drawImage(imageRect, mMapImage.mirrored(mirrorX, mirrorY));
+  localPainter->drawImage(imageRect, ringOrderedMapImage().mirrored(mirrorX, mirrorY));
   if (mTightBoundary)
     localPainter->setClipRegion(clipBackup);
   localPainter->setRenderHint(QPainter::SmoothPixmapTransform, smoothBackup);
@@ -20865,9 +21092,7 @@ void QCPFinancial::addData(const QVector<double> &key, const QVector<double> &op
 */
 void QCPFinancial::removeDataBefore(double key)
 {
-  QCPFinancialDataMap::iterator it = mData->begin();
-  while (it != mData->end() && it.key() < key)
-    it = mData->erase(it);
+  mData->erase(mData->begin(), mData->lowerBound(key));
 }
 
 /*!
@@ -20878,9 +21103,7 @@ void QCPFinancial::removeDataBefore(double key)
 void QCPFinancial::removeDataAfter(double key)
 {
   if (mData->isEmpty()) return;
-  QCPFinancialDataMap::iterator it = mData->upperBound(key);
-  while (it != mData->end())
-    it = mData->erase(it);
+  mData->erase(mData->upperBound(key), mData->end());
 }
 
 /*!
@@ -20893,10 +21116,7 @@ void QCPFinancial::removeDataAfter(double key)
 void QCPFinancial::removeData(double fromKey, double toKey)
 {
   if (fromKey >= toKey || mData->isEmpty()) return;
-  QCPFinancialDataMap::iterator it = mData->upperBound(fromKey);
-  QCPFinancialDataMap::iterator itEnd = mData->upperBound(toKey);
-  while (it != itEnd)
-    it = mData->erase(it);
+  mData->erase(mData->upperBound(fromKey), mData->upperBound(toKey));
 }
 
 /*! \overload
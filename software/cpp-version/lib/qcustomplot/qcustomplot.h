@@ -45,6 +45,8 @@
 #include <QMargins>
 #include <qmath.h>
 #include <limits>
+#include <algorithm>
+#include <iterator>
 #if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
 #  include <qnumeric.h>
 #  include <QPrinter>
@@ -371,8 +373,20 @@ class QCP_LIB_DECL QCPLayer : public QObject
   Q_PROPERTY(int index READ index)
   Q_PROPERTY(QList<QCPLayerable*> children READ children)
   Q_PROPERTY(bool visible READ visible WRITE setVisible)
+  Q_PROPERTY(LayerMode mode READ mode WRITE setMode)
   /// \endcond
 public:
+  /*!
+    Defines whether a layer is drawn into a paint buffer of its own, so it can be replotted
+    without redrawing the other layers.
+
+    \see setMode, replot
+  */
+  enum LayerMode { lmLogical   ///< Layer shares its paint buffer with the neighbouring logical layers
+                   ,lmBuffered ///< Layer has its own paint buffer and may be replotted individually (\ref replot)
+                 };
+  Q_ENUMS(LayerMode)
+  
   QCPLayer(QCustomPlot* parentPlot, const QString &layerName);
   ~QCPLayer();
   
@@ -382,9 +396,14 @@ public:
   int index() const { return mIndex; }
   QList<QCPLayerable*> children() const { return mChildren; }
   bool visible() const { return mVisible; }
+  LayerMode mode() const { return mMode; }
   
   // setters:
   void setVisible(bool visible);
+  void setMode(LayerMode mode);
+  
+  // non-virtual methods:
+  void replot();
   
 protected:
   // property members:
@@ -393,8 +412,13 @@ protected:
   int mIndex;
   QList<QCPLayerable*> mChildren;
   bool mVisible;
+  LayerMode mMode;
+  
+  // non-property members:
+  int mPaintBufferIndex;
   
   // non-virtual methods:
+  void draw(QCPPainter *painter);
   void addChild(QCPLayerable *layerable, bool prepend);
   void removeChild(QCPLayerable *layerable);
   
@@ -469,6 +493,7 @@ private:
   Q_DISABLE_COPY(QCPLayerable)
   
   friend class QCustomPlot;
+  friend class QCPLayer;
   friend class QCPAxisRect;
 };
 
@@ -1115,6 +1140,7 @@ public:
   double tickStep() const { return mTickStep; }
   QVector<double> tickVector() const { return mTickVector; }
   QVector<QString> tickVectorLabels() const { return mTickVectorLabels; }
+  QVector<double> subTickVector() const { return mSubTickVector; }
   int tickLengthIn() const;
   int tickLengthOut() const;
   int subTickCount() const { return mSubTickCount; }
@@ -1815,6 +1841,7 @@ public:
   QPixmap toPixmap(int width=0, int height=0, double scale=1.0);
   void toPainter(QCPPainter *painter, int width=0, int height=0);
   Q_SLOT void replot(QCustomPlot::RefreshPriority refreshPriority=QCustomPlot::rpHint);
+  void updateLayout();
   
   QCPAxis *xAxis, *yAxis, *xAxis2, *yAxis2;
   QCPLegend *legend;
@@ -1864,7 +1891,8 @@ protected:
   Qt::KeyboardModifier mMultiSelectModifier;
   
   // non-property members:
-  QPixmap mPaintBuffer;
+  QList<QPixmap> mPaintBuffers;
+  bool mPaintBuffersValid;
   QPoint mMousePressPos;
   QPointer<QCPLayoutElement> mMouseEventElement;
   bool mReplotting;
@@ -1889,6 +1917,9 @@ protected:
   void updateLayerIndices() const;
   QCPLayerable *layerableAt(const QPointF &pos, bool onlySelectable, QVariant *selectionDetails=0) const;
   void drawBackground(QCPPainter *painter);
+  void setupPaintBuffers();
+  bool drawPaintBuffer(int index);
+  void replotLayer(QCPLayer *layer);
   
   friend class QCPLegend;
   friend class QCPAxis;
@@ -2464,11 +2495,326 @@ private:
 
 
 
+/*!
+  A sorted, contiguous container for the data points of a plottable, ordered by the sort key of
+  \a DataType (its \c sortKey() method). It offers the subset of the QMap interface that plottables
+  and their users rely on (iterators with \c key() and \c value(), \ref lowerBound, \ref upperBound,
+  \ref insertMulti, \ref erase, ...), but keeps the points in one array, so bound lookups are
+  binary searches and iterating is a linear walk through memory. Appending points in key order,
+  which is how data usually arrives, is amortized constant time.
+  
+  The \a key passed to the inserting methods must equal the point's \c sortKey().
+*/
+template <class DataType>
+class QCPDataContainer
+{
+public:
+  class const_iterator;
+  
+  class iterator
+  {
+  public:
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef DataType value_type;
+    typedef qptrdiff difference_type;
+    typedef DataType *pointer;
+    typedef DataType &reference;
+    
+    iterator() : p(0) {}
+    explicit iterator(DataType *ptr) : p(ptr) {}
+    double key() const { return p->sortKey(); }
+    DataType &value() const { return *p; }
+    DataType &operator*() const { return *p; }
+    DataType *operator->() const { return p; }
+    bool operator==(const iterator &other) const { return p == other.p; }
+    bool operator!=(const iterator &other) const { return p != other.p; }
+    bool operator<(const iterator &other) const { return p < other.p; }
+    iterator &operator++() { ++p; return *this; }
+    iterator operator++(int) { iterator it = *this; ++p; return it; }
+    iterator &operator--() { --p; return *this; }
+    iterator operator--(int) { iterator it = *this; --p; return it; }
+    iterator &operator+=(int n) { p += n; return *this; }
+    iterator &operator-=(int n) { p -= n; return *this; }
+    iterator operator+(int n) const { return iterator(p+n); }
+    iterator operator-(int n) const { return iterator(p-n); }
+    difference_type operator-(const iterator &other) const { return p-other.p; }
+    
+  private:
+    DataType *p;
+    friend class const_iterator;
+  };
+  
+  class const_iterator
+  {
+  public:
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef DataType value_type;
+    typedef qptrdiff difference_type;
+    typedef const DataType *pointer;
+    typedef const DataType &reference;
+    
+    const_iterator() : p(0) {}
+    explicit const_iterator(const DataType *ptr) : p(ptr) {}
+    const_iterator(const iterator &other) : p(other.p) {}
+    double key() const { return p->sortKey(); }
+    const DataType &value() const { return *p; }
+    const DataType &operator*() const { return *p; }
+    const DataType *operator->() const { return p; }
+    friend bool operator==(const const_iterator &a, const const_iterator &b) { return a.p == b.p; }
+    friend bool operator!=(const const_iterator &a, const const_iterator &b) { return a.p != b.p; }
+    friend bool operator<(const const_iterator &a, const const_iterator &b) { return a.p < b.p; }
+    const_iterator &operator++() { ++p; return *this; }
+    const_iterator operator++(int) { const_iterator it = *this; ++p; return it; }
+    const_iterator &operator--() { --p; return *this; }
+    const_iterator operator--(int) { const_iterator it = *this; --p; return it; }
+    const_iterator &operator+=(int n) { p += n; return *this; }
+    const_iterator &operator-=(int n) { p -= n; return *this; }
+    const_iterator operator+(int n) const { return const_iterator(p+n); }
+    const_iterator operator-(int n) const { return const_iterator(p-n); }
+    friend difference_type operator-(const const_iterator &a, const const_iterator &b) { return a.p-b.p; }
+    
+  private:
+    const DataType *p;
+  };
+  
+  typedef iterator Iterator;
+  typedef const_iterator ConstIterator;
+  
+  // getters:
+  int size() const { return mItems.size(); }
+  int count() const { return mItems.size(); }
+  bool isEmpty() const { return mItems.isEmpty(); }
+  const QVector<DataType> &items() const { return mItems; }
+  
+  // iterators:
+  iterator begin() { return iterator(mItems.data()); }
+  iterator end() { return iterator(mItems.data()+mItems.size()); }
+  const_iterator begin() const { return constBegin(); }
+  const_iterator end() const { return constEnd(); }
+  const_iterator constBegin() const { return const_iterator(mItems.constData()); }
+  const_iterator constEnd() const { return const_iterator(mItems.constData()+mItems.size()); }
+  iterator lowerBound(double key) { return begin()+lowerIndex(key); }
+  iterator upperBound(double key) { return begin()+upperIndex(key); }
+  const_iterator lowerBound(double key) const { return constBegin()+lowerIndex(key); }
+  const_iterator upperBound(double key) const { return constBegin()+upperIndex(key); }
+  iterator find(double key) { int i = lowerIndex(key); return i < mItems.size() && mItems.at(i).sortKey() == key ? begin()+i : end(); }
+  const_iterator find(double key) const { return constFind(key); }
+  const_iterator constFind(double key) const { int i = lowerIndex(key); return i < mItems.size() && mItems.at(i).sortKey() == key ? constBegin()+i : constEnd(); }
+  
+  // lookup:
+  bool contains(double key) const { return constFind(key) != constEnd(); }
+  DataType value(double key, const DataType &defaultValue=DataType()) const { const_iterator it = constFind(key); return it != constEnd() ? *it : defaultValue; }
+  DataType &first() { return mItems.first(); }
+  const DataType &first() const { return mItems.first(); }
+  DataType &last() { return mItems.last(); }
+  const DataType &last() const { return mItems.last(); }
+  double firstKey() const { return mItems.first().sortKey(); }
+  double lastKey() const { return mItems.last().sortKey(); }
+  QList<double> keys() const { QList<double> result; result.reserve(mItems.size()); for (int i=0; i<mItems.size(); ++i) result.append(mItems.at(i).sortKey()); return result; }
+  QList<DataType> values() const { return mItems.toList(); }
+  
+  // modifiers:
+  void clear() { mItems.resize(0); } // keeps the capacity, so refilling every frame doesn't reallocate
+  void reserve(int size) { mItems.reserve(size); }
+  void squeeze() { mItems.squeeze(); }
+  iterator insert(double key, const DataType &data);
+  iterator insertMulti(double key, const DataType &data);
+  void unite(const QCPDataContainer &other);
+  void set(const QVector<DataType> &data, bool alreadySorted=false);
+  iterator erase(iterator pos) { return erase(pos, pos+1); }
+  iterator erase(iterator first, iterator last);
+  int remove(double key);
+  
+private:
+  QVector<DataType> mItems;
+  
+  int lowerIndex(double key) const;
+  int upperIndex(double key) const;
+  static bool lessKey(const DataType &a, const DataType &b) { return a.sortKey() < b.sortKey(); }
+};
+
+template <class DataType>
+int QCPDataContainer<DataType>::lowerIndex(double key) const
+{
+  int lo = 0, hi = mItems.size();
+  while (lo < hi)
+  {
+    int mid = lo + (hi-lo)/2;
+    if (mItems.at(mid).sortKey() < key)
+      lo = mid+1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+template <class DataType>
+int QCPDataContainer<DataType>::upperIndex(double key) const
+{
+  int lo = 0, hi = mItems.size();
+  while (lo < hi)
+  {
+    int mid = lo + (hi-lo)/2;
+    if (key < mItems.at(mid).sortKey())
+      hi = mid;
+    else
+      lo = mid+1;
+  }
+  return lo;
+}
+
+/*!
+  Inserts \a data at \a key, replacing the point already stored at that key, like QMap::insert.
+*/
+template <class DataType>
+typename QCPDataContainer<DataType>::iterator QCPDataContainer<DataType>::insert(double key, const DataType &data)
+{
+  int i = lowerIndex(key);
+  if (i < mItems.size() && mItems.at(i).sortKey() == key)
+    mItems[i] = data;
+  else
+    mItems.insert(i, data);
+  return begin()+i;
+}
+
+/*!
+  Inserts \a data at \a key, keeping points already stored at the same key; like QMap::insertMulti,
+  the newest point comes first among equal keys. Appending past the current last key is the fast
+  path and does not search.
+*/
+template <class DataType>
+typename QCPDataContainer<DataType>::iterator QCPDataContainer<DataType>::insertMulti(double key, const DataType &data)
+{
+  if (mItems.isEmpty() || mItems.last().sortKey() < key)
+  {
+    mItems.append(data);
+    return end()-1;
+  }
+  int i = lowerIndex(key);
+  mItems.insert(i, data);
+  return begin()+i;
+}
+
+/*!
+  Adds all points of \a other. When \a other starts at or after the current last key this is a
+  plain append, otherwise the two sorted runs are merged.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::unite(const QCPDataContainer &other)
+{
+  if (other.isEmpty())
+    return;
+  int oldSize = mItems.size();
+  bool ordered = isEmpty() || !(other.firstKey() < lastKey());
+  mItems += other.mItems;
+  if (!ordered)
+    std::inplace_merge(mItems.begin(), mItems.begin()+oldSize, mItems.end(), lessKey);
+}
+
+/*!
+  Replaces the contents with \a data in one go. Unless \a alreadySorted is true, the points are
+  sorted by key (stably, so equal keys keep their order); data that is already in order is only
+  checked, not sorted.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::set(const QVector<DataType> &data, bool alreadySorted)
+{
+  mItems = data;
+  if (!alreadySorted && !std::is_sorted(mItems.constBegin(), mItems.constEnd(), lessKey))
+    std::stable_sort(mItems.begin(), mItems.end(), lessKey);
+}
+
+/*!
+  Removes the points from \a first up to, but not including, \a last in one move of the remaining
+  tail, and returns an iterator to the point that followed them.
+*/
+template <class DataType>
+typename QCPDataContainer<DataType>::iterator QCPDataContainer<DataType>::erase(iterator first, iterator last)
+{
+  int i = first-begin();
+  mItems.remove(i, last-first);
+  return begin()+i;
+}
+
+/*!
+  Removes all points stored at \a key and returns how many there were.
+*/
+template <class DataType>
+int QCPDataContainer<DataType>::remove(double key)
+{
+  int lo = lowerIndex(key);
+  int n = upperIndex(key)-lo;
+  if (n > 0)
+    mItems.remove(lo, n);
+  return n;
+}
+
+/*!
+  A Java-style const iterator over a \ref QCPDataContainer, with the interface of QMapIterator.
+*/
+template <class DataType>
+class QCPDataContainerIterator
+{
+public:
+  typedef typename QCPDataContainer<DataType>::const_iterator const_iterator;
+  
+  QCPDataContainerIterator(const QCPDataContainer<DataType> &container) : c(&container), i(container.constBegin()), n(container.constEnd()) {}
+  void toFront() { i = c->constBegin(); n = c->constEnd(); }
+  void toBack() { i = c->constEnd(); n = c->constEnd(); }
+  bool hasNext() const { return i != c->constEnd(); }
+  bool hasPrevious() const { return i != c->constBegin(); }
+  const_iterator next() { n = i++; return n; }
+  const_iterator previous() { n = --i; return n; }
+  const_iterator peekNext() const { return i; }
+  const_iterator peekPrevious() const { return i-1; }
+  double key() const { return n.key(); }
+  const DataType &value() const { return n.value(); }
+  
+private:
+  const QCPDataContainer<DataType> *c;
+  const_iterator i, n;
+};
+
+/*!
+  A Java-style mutable iterator over a \ref QCPDataContainer, with the interface of
+  QMutableMapIterator.
+*/
+template <class DataType>
+class QCPDataContainerMutableIterator
+{
+public:
+  typedef typename QCPDataContainer<DataType>::iterator iterator;
+  
+  QCPDataContainerMutableIterator(QCPDataContainer<DataType> &container) : c(&container), i(container.begin()), n(container.end()) {}
+  void toFront() { i = c->begin(); n = c->end(); }
+  void toBack() { i = c->end(); n = c->end(); }
+  bool hasNext() const { return i != c->end(); }
+  bool hasPrevious() const { return i != c->begin(); }
+  iterator next() { n = i++; return n; }
+  iterator previous() { n = --i; return n; }
+  iterator peekNext() const { return i; }
+  iterator peekPrevious() const { return i-1; }
+  double key() const { return n.key(); }
+  DataType &value() const { return n.value(); }
+  void setValue(const DataType &data) const { *n = data; }
+  void remove() { if (n != c->end()) { i = c->erase(n); n = c->end(); } }
+  
+private:
+  QCPDataContainer<DataType> *c;
+  iterator i, n;
+};
+
+
+/*! \file */
+
+
+
 class QCP_LIB_DECL QCPData
 {
 public:
   QCPData();
   QCPData(double key, double value);
+  double sortKey() const { return key; }
   double key, value;
   double keyErrorPlus, keyErrorMinus;
   double valueErrorPlus, valueErrorMinus;
@@ -2476,15 +2822,15 @@ public:
 Q_DECLARE_TYPEINFO(QCPData, Q_MOVABLE_TYPE);
 
 /*! \typedef QCPDataMap
-  Container for storing \ref QCPData items in a sorted fashion. The key of the map
-  is the key member of the QCPData instance.
+  Container for storing \ref QCPData items in a sorted fashion, in one contiguous array (see
+  \ref QCPDataContainer). The key is the key member of the QCPData instance.
   
   This is the container in which QCPGraph holds its data.
   \see QCPData, QCPGraph::setData
 */
-typedef QMap<double, QCPData> QCPDataMap;
-typedef QMapIterator<double, QCPData> QCPDataMapIterator;
-typedef QMutableMapIterator<double, QCPData> QCPDataMutableMapIterator;
+typedef QCPDataContainer<QCPData> QCPDataMap;
+typedef QCPDataContainerIterator<QCPData> QCPDataMapIterator;
+typedef QCPDataContainerMutableIterator<QCPData> QCPDataMutableMapIterator;
 
 
 class QCP_LIB_DECL QCPGraph : public QCPAbstractPlottable
@@ -2640,21 +2986,22 @@ class QCP_LIB_DECL QCPCurveData
 public:
   QCPCurveData();
   QCPCurveData(double t, double key, double value);
+  double sortKey() const { return t; }
   double t, key, value;
 };
 Q_DECLARE_TYPEINFO(QCPCurveData, Q_MOVABLE_TYPE);
 
 /*! \typedef QCPCurveDataMap
-  Container for storing \ref QCPCurveData items in a sorted fashion. The key of the map
-  is the t member of the QCPCurveData instance.
+  Container for storing \ref QCPCurveData items in a sorted fashion, in one contiguous array (see
+  \ref QCPDataContainer). The key is the t member of the QCPCurveData instance.
   
   This is the container in which QCPCurve holds its data.
   \see QCPCurveData, QCPCurve::setData
 */
 
-typedef QMap<double, QCPCurveData> QCPCurveDataMap;
-typedef QMapIterator<double, QCPCurveData> QCPCurveDataMapIterator;
-typedef QMutableMapIterator<double, QCPCurveData> QCPCurveDataMutableMapIterator;
+typedef QCPDataContainer<QCPCurveData> QCPCurveDataMap;
+typedef QCPDataContainerIterator<QCPCurveData> QCPCurveDataMapIterator;
+typedef QCPDataContainerMutableIterator<QCPCurveData> QCPCurveDataMutableMapIterator;
 
 
 class QCP_LIB_DECL QCPCurve : public QCPAbstractPlottable
@@ -2804,20 +3151,21 @@ class QCP_LIB_DECL QCPBarData
 public:
   QCPBarData();
   QCPBarData(double key, double value);
+  double sortKey() const { return key; }
   double key, value;
 };
 Q_DECLARE_TYPEINFO(QCPBarData, Q_MOVABLE_TYPE);
 
 /*! \typedef QCPBarDataMap
-  Container for storing \ref QCPBarData items in a sorted fashion. The key of the map
-  is the key member of the QCPBarData instance.
+  Container for storing \ref QCPBarData items in a sorted fashion, in one contiguous array (see
+  \ref QCPDataContainer). The key is the key member of the QCPBarData instance.
   
   This is the container in which QCPBars holds its data.
   \see QCPBarData, QCPBars::setData
 */
-typedef QMap<double, QCPBarData> QCPBarDataMap;
-typedef QMapIterator<double, QCPBarData> QCPBarDataMapIterator;
-typedef QMutableMapIterator<double, QCPBarData> QCPBarDataMutableMapIterator;
+typedef QCPDataContainer<QCPBarData> QCPBarDataMap;
+typedef QCPDataContainerIterator<QCPBarData> QCPBarDataMapIterator;
+typedef QCPDataContainerMutableIterator<QCPBarData> QCPBarDataMutableMapIterator;
 
 
 class QCP_LIB_DECL QCPBars : public QCPAbstractPlottable
@@ -3066,6 +3414,7 @@ public:
   bool tightBoundary() const { return mTightBoundary; }
   QCPColorGradient gradient() const { return mGradient; }
   QCPColorScale *colorScale() const { return mColorScale.data(); }
+  int keyRingHead() const { return mKeyRingHead; }
   
   // setters:
   void setData(QCPColorMapData *data, bool copy=false);
@@ -3078,6 +3427,7 @@ public:
   
   // non-property methods:
   void rescaleDataRange(bool recalculateDataBounds=false);
+  void appendKeyColumn(const double *values);
   Q_SLOT void updateLegendIcon(Qt::TransformationMode transformMode=Qt::SmoothTransformation, const QSize &thumbSize=QSize(32, 18));
   
   // reimplemented virtual methods:
@@ -3099,13 +3449,17 @@ protected:
   bool mTightBoundary;
   QPointer<QCPColorScale> mColorScale;
   // non-property members:
-  QImage mMapImage, mUndersampledMapImage;
+  QImage mMapImage, mUndersampledMapImage, mRingImage;
   QPixmap mLegendIcon;
   bool mMapImageInvalidated;
+  int mKeyRingHead;
   
   // introduced virtual methods:
   virtual void updateMapImage();
   
+  // non-virtual methods:
+  const QImage &ringOrderedMapImage();
+  
   // reimplemented virtual methods:
   virtual void draw(QCPPainter *painter);
   virtual void drawLegendIcon(QCPPainter *painter, const QRectF &rect) const;
@@ -3126,20 +3480,21 @@ class QCP_LIB_DECL QCPFinancialData
 public:
   QCPFinancialData();
   QCPFinancialData(double key, double open, double high, double low, double close);
+  double sortKey() const { return key; }
   double key, open, high, low, close;
 };
 Q_DECLARE_TYPEINFO(QCPFinancialData, Q_MOVABLE_TYPE);
 
 /*! \typedef QCPFinancialDataMap
-  Container for storing \ref QCPFinancialData items in a sorted fashion. The key of the map
-  is the key member of the QCPFinancialData instance.
+  Container for storing \ref QCPFinancialData items in a sorted fashion, in one contiguous array (see
+  \ref QCPDataContainer). The key is the key member of the QCPFinancialData instance.
   
   This is the container in which QCPFinancial holds its data.
   \see QCPFinancial, QCPFinancial::setData
 */
-typedef QMap<double, QCPFinancialData> QCPFinancialDataMap;
-typedef QMapIterator<double, QCPFinancialData> QCPFinancialDataMapIterator;
-typedef QMutableMapIterator<double, QCPFinancialData> QCPFinancialDataMutableMapIterator;
+typedef QCPDataContainer<QCPFinancialData> QCPFinancialDataMap;
+typedef QCPDataContainerIterator<QCPFinancialData> QCPFinancialDataMapIterator;
+typedef QCPDataContainerMutableIterator<QCPFinancialData> QCPFinancialDataMutableMapIterator;
 
 
 class QCP_LIB_DECL QCPFinancial : public QCPAbstractPlottable
@@ -1,11 +1,12 @@
 #!/bin/bash
 
 if [ "$1" == "init" ]; then
-    mkdir -p bin/ bin/obj/ bin/moc/
-    qmake
+    mkdir -p bin/ bin/obj/ bin/moc/ bin/obj-cli/ bin/moc-cli/
+    qmake uart-scope.pro -o Makefile
+    qmake uart-scope-cli.pro -o Makefile.cli
 elif [ "$1" == "build" ]; then
-    if [ -f Makefile ]; then
-        make
+    if [ -f Makefile ] && [ -f Makefile.cli ]; then
+        make && make -f Makefile.cli
     else
         echo "Makefile not found. Run: \"$0 init\""
     fi
@@ -18,6 +19,9 @@ elif [ "$1" == "clean_all" ]; then
     if [ -f Makefile ]; then
         make distclean
     fi
+    if [ -f Makefile.cli ]; then
+        make -f Makefile.cli distclean
+    fi
     if [ -d bin/ ]; then
         rm -r bin/
     fi
@@ -25,7 +29,7 @@ elif [ "$1" == "clean_all" ]; then
 else
     echo "Usage: $0 [init|build|clean|clean_all]"
     echo "- init:      Inizialize the Qt project and create the Makefile."
-    echo "- build:     Build the project creating the executable."
+    echo "- build:     Build the project creating the uart-scope and uart-scope-cli executables."
     echo "- clean:     Clean the executable and the object files."
     echo "- clean_all: Clean all the files generated by the \"init\" and \"build\" commands."
 fi
@@ -0,0 +1,213 @@
+#include "acquisition.h"
+
+Acquisition::Acquisition(int channels, SampleStore *store, CaptureWriter *writer, QObject *parent) : QObject(parent), channels(channels), store(store), writer(writer), server(nullptr), phosphor(nullptr), dataSource(nullptr), running(false), ingestedFrames(0), clockStart(0) {
+#ifdef Q_OS_UNIX
+    ring = nullptr;
+#endif
+    frame.resize(channels);
+    timestampBuffer.resize(ACQUISITION_BATCH_FRAMES);
+}
+
+Acquisition::~Acquisition(void) {
+    stop();
+}
+
+// Swaps the store and writer, e.g. when a source brings a different channel count.
+void Acquisition::setSinks(int channels, SampleStore *store, CaptureWriter *writer) {
+    this->channels = channels;
+    this->store = store;
+    this->writer = writer;
+    frame.resize(channels);
+    if (running) {
+        applyScales();
+    }
+}
+
+void Acquisition::setServer(SampleServer *server) {
+    this->server = server;
+    if (server && running) {
+        applyScales();
+    }
+}
+
+void Acquisition::setPhosphor(Phosphor *phosphor) {
+    this->phosphor = phosphor;
+    if (phosphor && running) {
+        applyScales();
+    }
+}
+
+#ifdef Q_OS_UNIX
+void Acquisition::setSharedRing(SharedRingPublisher *ring) {
+    this->ring = ring;
+    if (ring && running) {
+        applyScales();
+    }
+}
+#endif
+
+void Acquisition::setSource(DataSource *source) {
+    stop();
+    if (dataSource) {
+        dataSource->deleteLater();
+    }
+    dataSource = source;
+    if (dataSource) {
+        dataSource->setParent(this);
+    }
+}
+
+bool Acquisition::start(QString *error) {
+    if (!dataSource) {
+        if (error) {
+            *error = "No data source selected";
+        }
+        return false;
+    }
+
+    if (!dataSource->open(error)) {
+        return false;
+    }
+
+    frameBuffer.resize(ACQUISITION_BATCH_FRAMES * dataSource->channelCount());
+    applyScales();
+    ingestedFrames = 0;
+    resetClock();
+    running = true;
+    return true;
+}
+
+// Needed whenever the source's timeline jumps, e.g. after seeking a replay.
+void Acquisition::resetClock(void) {
+    clock.reset();
+    clockStart = ingestedFrames;
+}
+
+// Maps store indices to seconds on the source clock: time = origin + index * period.
+bool Acquisition::sampleTimeBase(double *origin, double *period) const {
+    if (!clock.isValid() || !store) {
+        return false;
+    }
+    qint64 storeStart = ingestedFrames - clockStart - store->endIndex();
+    *origin = clock.timeOf(storeStart) / 1e9;
+    *period = clock.period() / 1e9;
+    return true;
+}
+
+void Acquisition::applyScales(void) {
+    if (store) {
+        for (int i = 0; i < channels && i < dataSource->channelCount(); ++i) {
+            store->setScale(i, dataSource->scale(i));
+        }
+    }
+
+    QVector<ChannelScale> scales;
+    for (int i = 0; i < dataSource->channelCount(); ++i) {
+        scales.append(dataSource->scale(i));
+    }
+    if (server) {
+        server->setScales(scales);
+    }
+    if (phosphor) {
+        phosphor->setScales(scales);
+    }
+#ifdef Q_OS_UNIX
+    if (ring) {
+        ring->setScales(scales, nullptr);
+    }
+#endif
+}
+
+void Acquisition::stop(void) {
+    if (dataSource && dataSource->isOpen()) {
+        dataSource->close();
+    }
+    running = false;
+}
+
+void Acquisition::pause(void) {
+    if (dataSource) {
+        dataSource->pause();
+    }
+}
+
+bool Acquisition::resume(QString *error) {
+    return dataSource && dataSource->resume(error);
+}
+
+int Acquisition::poll(void) {
+    if (!running || !dataSource->isOpen()) {
+        return 0;
+    }
+
+    int sourceChannels = dataSource->channelCount();
+    int total = 0;
+    int count;
+    while (total < ACQUISITION_POLL_LIMIT && (count = dataSource->readFrames(frameBuffer.data(), timestampBuffer.data(), ACQUISITION_BATCH_FRAMES)) > 0) {
+        ingest(frameBuffer.constData(), timestampBuffer.constData(), count, sourceChannels);
+        observeTimestamps(timestampBuffer.constData(), count);
+        ingestedFrames += count;
+        if (server) {
+            server->publish(frameBuffer.constData(), timestampBuffer.constData(), count, sourceChannels);
+        }
+        if (phosphor) {
+            phosphor->publish(frameBuffer.constData(), count, sourceChannels);
+        }
+#ifdef Q_OS_UNIX
+        if (ring) {
+            ring->publish(frameBuffer.constData(), timestampBuffer.constData(), count, sourceChannels);
+        }
+#endif
+        total += count;
+    }
+    return total;
+}
+
+AcquisitionStats Acquisition::stats(void) const {
+    AcquisitionStats stats;
+    stats.frames = ingestedFrames;
+    stats.channels = channels;
+    if (dataSource) {
+        stats.source = dataSource->stats();
+    }
+    if (writer) {
+        stats.writerDroppedFrames = writer->droppedFrames();
+    }
+    if (server) {
+        stats.serverDroppedFrames = server->droppedFrames();
+    }
+    if (phosphor) {
+        stats.phosphorDroppedFrames = phosphor->droppedFrames();
+    }
+    return stats;
+}
+
+// Stream sources stamp every frame decoded from one read with the time of that
+// read, so only the last frame of each run of equal stamps is an observation.
+void Acquisition::observeTimestamps(const qint64 *timestamps, int count) {
+    qint64 base = ingestedFrames - clockStart;
+    for (int n = 0; n < count; ++n) {
+        if (n + 1 == count || timestamps[n + 1] != timestamps[n]) {
+            clock.addObservation(base + n, timestamps[n]);
+        }
+    }
+}
+
+void Acquisition::ingest(const int16_t *frames, const qint64 *timestamps, int count, int sourceChannels) {
+    for (int n = 0; n < count; ++n) {
+        const int16_t *sourceFrame = frames + n * sourceChannels;
+        if (sourceChannels != channels) {
+            for (int i = 0; i < channels; ++i) {
+                frame[i] = i < sourceChannels ? sourceFrame[i] : 0;
+            }
+            sourceFrame = frame.constData();
+        }
+
+        if (store) {
+            store->append(sourceFrame);
+        }
+        if (writer) {
+            writer->append(sourceFrame, timestamps[n]);
+        }
+    }
+}
@@ -0,0 +1,131 @@
+#include <QSerialPort>
+#include <QElapsedTimer>
+#include <cstring>
+
+#include "bauddetector.h"
+#include "captureformat.h"
+
+BaudDetector::BaudDetector(const QString &portName, QObject *parent) : QThread(parent), portName(portName), detectedBaud(0), detectedChannels(0), bestScore(0) {
+}
+
+// Most likely rates first, so a typical board locks on the first probes.
+QVector<int> BaudDetector::candidates(void) {
+    return { 115200, 9600, 230400, 57600, 460800, 921600, 38400, 19200 };
+}
+
+static inline bool isLineChar(char c) {
+    return (c >= '0' && c <= '9') || c == '\t' || c == ' ' || c == '-' || c == '+' || c == '\r';
+}
+
+// Fraction of the complete lines in data that are tab-separated integers with
+// the most common field count, weighted by the share of bytes that belong to
+// such lines. Garbage from a wrong rate rarely contains newlines at all.
+double BaudDetector::scoreLines(const QByteArray &data, int *channels) {
+    const char *p = data.constData();
+    const char *end = p + data.size();
+
+    // The first line is most likely cut, skip it.
+    const char *line = static_cast<const char*>(memchr(p, '\n', end - p));
+    if (!line) {
+        return 0.0;
+    }
+    ++line;
+
+    int counts[CAPTURE_MAX_CHANNELS + 1] = {};
+    int lines = 0;
+    qint64 goodBytes = 0;
+    qint64 totalBytes = 0;
+    const char *newline;
+    while ((newline = static_cast<const char*>(memchr(line, '\n', end - line)))) {
+        ++lines;
+        totalBytes += newline - line + 1;
+
+        int fields = 1;
+        bool digits = false;
+        bool valid = true;
+        for (const char *c = line; c < newline; ++c) {
+            if (!isLineChar(*c)) {
+                valid = false;
+                break;
+            }
+            fields += *c == '\t';
+            digits |= *c >= '0' && *c <= '9';
+        }
+        if (valid && digits && fields <= CAPTURE_MAX_CHANNELS) {
+            ++counts[fields];
+            goodBytes += newline - line + 1;
+        }
+        line = newline + 1;
+    }
+
+    if (lines < BAUD_DETECT_MIN_LINES) {
+        return 0.0;
+    }
+
+    int best = 1;
+    for (int i = 2; i <= CAPTURE_MAX_CHANNELS; ++i) {
+        if (counts[i] > counts[best]) {
+            best = i;
+        }
+    }
+    if (channels) {
+        *channels = best;
+    }
+    return double(counts[best]) / lines * goodBytes / totalBytes;
+}
+
+void BaudDetector::run(void) {
+    detectedBaud = 0;
+    detectedChannels = 0;
+    bestScore = 0;
+    error.clear();
+
+    QSerialPort port;
+    port.setPortName(portName);
+    port.setBaudRate(candidates().first());
+    if (!port.open(QIODevice::ReadWrite)) {
+        error = port.errorString();
+        emit failed(error);
+        return;
+    }
+
+    // Boards that reset when the port opens need a moment before they talk;
+    // bytes at any rate mean the firmware is running.
+    QElapsedTimer timer;
+    timer.start();
+    while (port.bytesAvailable() == 0 && timer.elapsed() < BAUD_DETECT_SETTLE_MS) {
+        port.waitForReadyRead(50);
+    }
+
+    for (int rate : candidates()) {
+        port.setBaudRate(rate);
+        port.clear(QSerialPort::Input);
+
+        QByteArray data;
+        timer.restart();
+        while (data.size() < BAUD_DETECT_PROBE_BYTES && timer.elapsed() < BAUD_DETECT_PROBE_MS) {
+            if (port.waitForReadyRead(BAUD_DETECT_PROBE_MS - timer.elapsed())) {
+                data += port.readAll();
+            }
+        }
+
+        int channels = 0;
+        double rateScore = scoreLines(data, &channels);
+        if (rateScore > bestScore) {
+            bestScore = rateScore;
+            detectedBaud = rate;
+            detectedChannels = channels;
+        }
+        if (rateScore >= BAUD_DETECT_LOCK_SCORE) {
+            break;
+        }
+    }
+    port.close();
+
+    if (detectedBaud == 0 || bestScore < BAUD_DETECT_MIN_SCORE) {
+        error = "No valid data received at any baud rate";
+        emit failed(error);
+        return;
+    }
+    emit detected(detectedBaud, detectedChannels);
+}
@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <cstring>
+
+#include "capturereader.h"
+
+CaptureReader::CaptureReader(void) : frames(0) {
+    memset(&header, 0, sizeof(header));
+}
+
+CaptureReader::~CaptureReader(void) {
+    close();
+}
+
+bool CaptureReader::open(const QString &path, QString *error) {
+    close();
+
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) {
+            *error = file.errorString();
+        }
+        return false;
+    }
+
+    QString problem;
+    if (file.read(reinterpret_cast<char*>(&header), sizeof(header)) != sizeof(header)) {
+        problem = "File is too short to be a capture";
+    } else if (memcmp(header.magic, CAPTURE_MAGIC, sizeof(header.magic)) != 0) {
+        problem = "Not a uart-scope capture file";
+    } else if (header.version != CAPTURE_VERSION) {
+        problem = QString("Unsupported capture version %1").arg(header.version);
+    } else if (header.channels == 0 || header.channels > CAPTURE_MAX_CHANNELS) {
+        problem = QString("Invalid channel count %1").arg(header.channels);
+    } else if (header.indexOffset == 0) {
+        if (!rebuildIndex()) {
+            problem = "Capture was not closed cleanly and no chunk could be recovered";
+        }
+    } else if (header.indexOffset > quint64(file.size()) || header.chunkCount > (quint64(file.size()) - header.indexOffset) / sizeof(CaptureIndexEntry)) {
+        problem = "Capture index is truncated";
+    } else {
+        // Checked against the file size above, so a corrupt count can't ask
+        // for more than the file holds.
+        index.resize(int(header.chunkCount));
+        qint64 bytes = index.size() * sizeof(CaptureIndexEntry);
+        if (!file.seek(header.indexOffset) || file.read(reinterpret_cast<char*>(index.data()), bytes) != bytes) {
+            problem = "Capture index is truncated";
+        }
+        // Recording stopped before the first frame leaves a valid, empty capture.
+        frames = index.isEmpty() ? 0 : header.frameCount;
+    }
+
+    if (!problem.isEmpty()) {
+        if (error) {
+            *error = problem;
+        }
+        close();
+        return false;
+    }
+    return true;
+}
+
+void CaptureReader::close(void) {
+    file.close();
+    index.clear();
+    frames = 0;
+}
+
+bool CaptureReader::rebuildIndex(void) {
+    qint64 pos = sizeof(CaptureHeader);
+    qint64 size = file.size();
+    frames = 0;
+
+    while (pos + qint64(sizeof(CaptureChunkHeader) + sizeof(qint64)) <= size) {
+        CaptureChunkHeader chunkHeader;
+        qint64 firstTimestamp;
+        if (!file.seek(pos)
+            || file.read(reinterpret_cast<char*>(&chunkHeader), sizeof(chunkHeader)) != sizeof(chunkHeader)
+            || chunkHeader.magic != CAPTURE_CHUNK_MAGIC || chunkHeader.frames == 0 || chunkHeader.frames > CAPTURE_CHUNK_FRAMES
+            || file.read(reinterpret_cast<char*>(&firstTimestamp), sizeof(firstTimestamp)) != sizeof(firstTimestamp)) {
+            break;
+        }
+
+        qint64 next = pos + sizeof(chunkHeader) + captureChunkPayloadSize(header.channels, chunkHeader.frames);
+        if (next > size) {
+            break;
+        }
+
+        index.append({ chunkHeader.firstFrame, quint64(pos), firstTimestamp });
+        frames = chunkHeader.firstFrame + chunkHeader.frames;
+        pos = next;
+    }
+
+    return !index.isEmpty();
+}
+
+ChannelScale CaptureReader::scale(int channel) const {
+    ChannelScale scale;
+    const CaptureCalibration &calibration = header.calibration[channel];
+    scale.gain = calibration.gain;
+    scale.offset = calibration.offset;
+    scale.unit = QString::fromUtf8(calibration.unit, qstrnlen(calibration.unit, sizeof(calibration.unit)));
+    return scale;
+}
+
+int CaptureReader::chunkForFrame(quint64 frame) const {
+    auto it = std::upper_bound(index.constBegin(), index.constEnd(), frame, [](quint64 value, const CaptureIndexEntry &entry) {
+        return value < entry.firstFrame;
+    });
+    return qMax(0, int(it - index.constBegin()) - 1);
+}
+
+int CaptureReader::chunkForTimestamp(qint64 timestamp) const {
+    auto it = std::upper_bound(index.constBegin(), index.constEnd(), timestamp, [](qint64 value, const CaptureIndexEntry &entry) {
+        return value < entry.firstTimestamp;
+    });
+    return qMax(0, int(it - index.constBegin()) - 1);
+}
+
+// The chunk header comes from the file too: its frame count is checked
+// against what the writer produces and what is left of the file before
+// anything is allocated for it.
+bool CaptureReader::readChunk(int chunk, CaptureChunk &out) {
+    if (chunk < 0 || chunk >= index.size()) {
+        return false;
+    }
+    const CaptureIndexEntry &entry = index[chunk];
+    CaptureChunkHeader chunkHeader;
+    if (!file.seek(entry.offset)
+        || file.read(reinterpret_cast<char*>(&chunkHeader), sizeof(chunkHeader)) != sizeof(chunkHeader)
+        || chunkHeader.magic != CAPTURE_CHUNK_MAGIC || chunkHeader.frames == 0 || chunkHeader.frames > CAPTURE_CHUNK_FRAMES
+        || captureChunkPayloadSize(header.channels, chunkHeader.frames) > file.size() - file.pos()) {
+        return false;
+    }
+
+    out.firstFrame = chunkHeader.firstFrame;
+    out.frames = chunkHeader.frames;
+    out.timestamps.resize(out.frames);
+    out.samples.resize(out.frames * header.channels);
+
+    qint64 bytes = out.frames * sizeof(qint64);
+    if (file.read(reinterpret_cast<char*>(out.timestamps.data()), bytes) != bytes) {
+        return false;
+    }
+    bytes = out.samples.size() * sizeof(int16_t);
+    return file.read(reinterpret_cast<char*>(out.samples.data()), bytes) == bytes;
+}
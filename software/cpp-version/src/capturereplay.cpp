@@ -0,0 +1,122 @@
+#include "capturereplay.h"
+
+CaptureReplay::CaptureReplay(const QString &path, QObject *parent) : DataSource(parent), fileName(path), chunkIndex(-1), position(0), speedFactor(1.0), isPaused(false), anchorTimestamp(0) {
+}
+
+bool CaptureReplay::open(QString *error) {
+    close();
+    if (!reader.open(fileName, error)) {
+        return false;
+    }
+
+    // An empty capture is at its end straight away and has no chunk to load.
+    if (reader.chunkCount() > 0 && !loadChunkFor(0)) {
+        if (error) {
+            *error = "Error reading the first chunk of the capture";
+        }
+        reader.close();
+        return false;
+    }
+
+    restartClock();
+    return true;
+}
+
+void CaptureReplay::close(void) {
+    reader.close();
+    chunkIndex = -1;
+    chunk.frames = 0;
+    position = 0;
+    isPaused = false;
+}
+
+bool CaptureReplay::loadChunkFor(quint64 frame) {
+    int wanted = reader.chunkForFrame(frame);
+    if (wanted != chunkIndex) {
+        if (!reader.readChunk(wanted, chunk)) {
+            chunkIndex = -1;
+            chunk.frames = 0;
+            return false;
+        }
+        chunkIndex = wanted;
+    }
+    return true;
+}
+
+// The clock is re-anchored on the next frame to be delivered whenever pacing
+// changes, so a seek or speed change never produces a burst of catch-up frames.
+void CaptureReplay::restartClock(void) {
+    if (!atEnd() && position - chunk.firstFrame >= quint64(chunk.frames)) {
+        loadChunkFor(position);
+    }
+    quint64 offset = position - chunk.firstFrame;
+    anchorTimestamp = offset < quint64(chunk.frames) ? chunk.timestamps[offset] : 0;
+    clock.start();
+}
+
+void CaptureReplay::setSpeed(double factor) {
+    speedFactor = factor;
+    restartClock();
+}
+
+void CaptureReplay::pause(void) {
+    isPaused = true;
+}
+
+bool CaptureReplay::resume(QString *error) {
+    Q_UNUSED(error);
+    isPaused = false;
+    restartClock();
+    return isOpen();
+}
+
+bool CaptureReplay::seek(quint64 frame) {
+    if (!isOpen()) {
+        return false;
+    }
+
+    position = qMin(frame, reader.frameCount());
+    if (!atEnd() && !loadChunkFor(position)) {
+        return false;
+    }
+    restartClock();
+    return true;
+}
+
+int CaptureReplay::readFrames(int16_t *frames, qint64 *timestamps, int maxFrames) {
+    if (!isOpen() || isPaused) {
+        return 0;
+    }
+
+    int channels = reader.channelCount();
+    qint64 due = anchorTimestamp + qint64(clock.nsecsElapsed() * speedFactor);
+    int count = 0;
+
+    while (count < maxFrames && !atEnd()) {
+        quint64 offset = position - chunk.firstFrame;
+        if (offset >= quint64(chunk.frames)) {
+            // A corrupt index can point back at the chunk already loaded,
+            // which doesn't hold the frame either; stop instead of spinning.
+            int previous = chunkIndex;
+            if (!loadChunkFor(position) || chunkIndex == previous) {
+                position = reader.frameCount();
+                break;
+            }
+            continue;
+        }
+
+        qint64 timestamp = chunk.timestamps[offset];
+        if (speedFactor != REPLAY_SPEED_MAX && timestamp > due) {
+            break;
+        }
+
+        for (int i = 0; i < channels; ++i) {
+            frames[count * channels + i] = chunk.channelData(i)[offset];
+        }
+        timestamps[count] = timestamp;
+        ++position;
+        ++count;
+    }
+
+    return count;
+}
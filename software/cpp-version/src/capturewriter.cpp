@@ -0,0 +1,223 @@
+#include <QDateTime>
+#include <QMutexLocker>
+#include <cstring>
+
+#include "capturewriter.h"
+
+CaptureWriter::CaptureWriter(int channels, QObject *parent) : QThread(parent), channels(channels), recording(false), waitForChunks(false), current(nullptr), nextFrame(0), firstTimestamp(-1), lastTimestamp(-1), stopping(false), failed(false), writtenFrames(0), lostFrames(0) {
+    for (int i = 0; i < CAPTURE_POOL_CHUNKS; ++i) {
+        Chunk *chunk = new Chunk;
+        chunk->timestamps.resize(CAPTURE_CHUNK_FRAMES);
+        chunk->samples.resize(CAPTURE_CHUNK_FRAMES * channels);
+        pool.append(chunk);
+    }
+}
+
+CaptureWriter::~CaptureWriter(void) {
+    close();
+    qDeleteAll(pool);
+}
+
+bool CaptureWriter::open(const QString &path, const QVector<ChannelScale> &scales, QString *error) {
+    close();
+
+    if (channels > CAPTURE_MAX_CHANNELS) {
+        if (error) {
+            *error = QString("Captures hold at most %1 channels, not %2").arg(CAPTURE_MAX_CHANNELS).arg(channels);
+        }
+        return false;
+    }
+
+    file.setFileName(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (error) {
+            *error = file.errorString();
+        }
+        return false;
+    }
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CAPTURE_MAGIC, sizeof(header.magic));
+    header.version = CAPTURE_VERSION;
+    header.channels = channels;
+    header.startTime = QDateTime::currentMSecsSinceEpoch();
+    for (int i = 0; i < channels && i < scales.size(); ++i) {
+        CaptureCalibration &calibration = header.calibration[i];
+        calibration.gain = scales[i].gain;
+        calibration.offset = scales[i].offset;
+        QByteArray unit = scales[i].unit.toUtf8().left(sizeof(calibration.unit) - 1);
+        memcpy(calibration.unit, unit.constData(), unit.size());
+    }
+
+    if (file.write(reinterpret_cast<const char*>(&header), sizeof(header)) != sizeof(header)) {
+        if (error) {
+            *error = file.errorString();
+        }
+        file.close();
+        return false;
+    }
+
+    index.clear();
+    pending.clear();
+    freeChunks = pool;
+    nextFrame = 0;
+    firstTimestamp = -1;
+    lastTimestamp = -1;
+    stopping = false;
+    failed = false;
+    writtenFrames.storeRelease(0);
+    lostFrames.storeRelease(0);
+    current = takeFreeChunk();
+
+    recording = true;
+    start();
+    return true;
+}
+
+void CaptureWriter::close(void) {
+    if (!recording) {
+        return;
+    }
+
+    if (current && current->frames > 0) {
+        submitCurrent();
+    }
+
+    {
+        QMutexLocker locker(&mutex);
+        stopping = true;
+        chunkReady.wakeAll();
+    }
+    wait();
+
+    if (!finish() && !failed) {
+        emit writeError(file.errorString());
+    }
+    file.close();
+    current = nullptr;
+    recording = false;
+}
+
+CaptureWriter::Chunk *CaptureWriter::takeFreeChunk(void) {
+    if (freeChunks.isEmpty()) {
+        return nullptr;
+    }
+    Chunk *chunk = freeChunks.takeLast();
+    chunk->firstFrame = nextFrame;
+    chunk->frames = 0;
+    return chunk;
+}
+
+void CaptureWriter::append(const int16_t *frame, qint64 timestamp) {
+    if (!recording) {
+        return;
+    }
+
+    if (!current) {
+        QMutexLocker locker(&mutex);
+        current = takeFreeChunk();
+        while (!current && waitForChunks) {
+            chunkFree.wait(&mutex);
+            current = takeFreeChunk();
+        }
+        if (!current) {
+            lostFrames.fetchAndAddRelaxed(1);
+            return;
+        }
+    }
+
+    int n = current->frames;
+    current->timestamps[n] = timestamp;
+    for (int i = 0; i < channels; ++i) {
+        current->samples[i * CAPTURE_CHUNK_FRAMES + n] = frame[i];
+    }
+    current->frames = n + 1;
+    ++nextFrame;
+
+    if (firstTimestamp < 0) {
+        firstTimestamp = timestamp;
+    }
+    lastTimestamp = timestamp;
+
+    if (current->frames == CAPTURE_CHUNK_FRAMES || timestamp - current->timestamps[0] >= CAPTURE_FLUSH_INTERVAL_NS) {
+        submitCurrent();
+    }
+}
+
+void CaptureWriter::submitCurrent(void) {
+    QMutexLocker locker(&mutex);
+    pending.enqueue(current);
+    current = takeFreeChunk();
+    chunkReady.wakeOne();
+}
+
+void CaptureWriter::run(void) {
+    forever {
+        Chunk *chunk;
+        {
+            QMutexLocker locker(&mutex);
+            while (pending.isEmpty() && !stopping) {
+                chunkReady.wait(&mutex);
+            }
+            if (pending.isEmpty()) {
+                break;
+            }
+            chunk = pending.dequeue();
+        }
+
+        if (!failed && !writeChunk(chunk)) {
+            failed = true;
+            emit writeError(file.errorString());
+        }
+
+        QMutexLocker locker(&mutex);
+        freeChunks.append(chunk);
+        chunkFree.wakeOne();
+    }
+}
+
+bool CaptureWriter::writeChunk(const Chunk *chunk) {
+    CaptureIndexEntry entry = { chunk->firstFrame, quint64(file.pos()), chunk->timestamps[0] };
+    CaptureChunkHeader chunkHeader = { CAPTURE_CHUNK_MAGIC, quint32(chunk->frames), chunk->firstFrame };
+
+    if (file.write(reinterpret_cast<const char*>(&chunkHeader), sizeof(chunkHeader)) != sizeof(chunkHeader)) {
+        return false;
+    }
+
+    qint64 bytes = chunk->frames * sizeof(qint64);
+    if (file.write(reinterpret_cast<const char*>(chunk->timestamps.constData()), bytes) != bytes) {
+        return false;
+    }
+
+    bytes = chunk->frames * sizeof(int16_t);
+    for (int i = 0; i < channels; ++i) {
+        const int16_t *samples = chunk->samples.constData() + i * CAPTURE_CHUNK_FRAMES;
+        if (file.write(reinterpret_cast<const char*>(samples), bytes) != bytes) {
+            return false;
+        }
+    }
+
+    index.append(entry);
+    writtenFrames.fetchAndAddRelease(chunk->frames);
+    return true;
+}
+
+bool CaptureWriter::finish(void) {
+    if (failed) {
+        return false;
+    }
+
+    header.indexOffset = file.pos();
+    header.chunkCount = index.size();
+    header.frameCount = writtenFrames.loadAcquire();
+    if (header.frameCount > 1 && lastTimestamp > firstTimestamp) {
+        header.sampleRate = (header.frameCount - 1) * 1e9 / (lastTimestamp - firstTimestamp);
+    }
+
+    qint64 bytes = index.size() * sizeof(CaptureIndexEntry);
+    if (file.write(reinterpret_cast<const char*>(index.constData()), bytes) != bytes) {
+        return false;
+    }
+
+    return file.seek(0) && file.write(reinterpret_cast<const char*>(&header), sizeof(header)) == sizeof(header);
+}
@@ -0,0 +1,192 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTimer>
+#include <csignal>
+#include <cstdio>
+
+#include "headlesslogger.h"
+#include "serialsource.h"
+#include "bauddetector.h"
+#include "syntheticsource.h"
+#include "multisource.h"
+#include "capturereplay.h"
+#ifdef Q_OS_UNIX
+#include "ptysource.h"
+#endif
+
+#define CLI_CHANNELS 4
+#define CLI_DEFAULT_BAUD 115200
+
+static volatile std::sig_atomic_t interrupted = 0;
+
+static void onInterrupt(int) {
+    interrupted = 1;
+}
+
+// All ports are probed at once, so detection takes as long as the slowest one.
+static bool detectBaudRates(const QStringList &ports, QVector<int> &baudRates, QVector<int> &channels, QString *error) {
+    QVector<BaudDetector*> detectors;
+    for (const QString &port : ports) {
+        detectors.append(new BaudDetector(port));
+        detectors.last()->start();
+    }
+
+    bool ok = true;
+    for (int i = 0; i < detectors.size(); ++i) {
+        BaudDetector *detector = detectors[i];
+        detector->wait();
+        if (detector->baudRate() <= 0 || detector->score() < BAUD_DETECT_MIN_SCORE) {
+            if (ok) {
+                *error = QString("%1: %2").arg(ports[i], detector->errorString());
+            }
+            ok = false;
+        } else {
+            baudRates[i] = detector->baudRate();
+            channels[i] = detector->channelCount();
+            fprintf(stderr, "%s: detected %d baud, %d channels\n", qPrintable(ports[i]), baudRates[i], channels[i]);
+        }
+        delete detector;
+    }
+    return ok;
+}
+
+static DataSource *createSource(const QCommandLineParser &parser, QString *error) {
+    if (parser.isSet("synthetic")) {
+        return new SyntheticSource(CLI_CHANNELS);
+    }
+    if (parser.isSet("replay")) {
+        CaptureReplay *replay = new CaptureReplay(parser.value("replay"));
+        replay->setSpeed(parser.isSet("realtime") ? 1.0 : REPLAY_SPEED_MAX);
+        return replay;
+    }
+#ifdef Q_OS_UNIX
+    if (parser.isSet("pty")) {
+        return new PtySource(CLI_CHANNELS);
+    }
+#endif
+
+    QStringList ports = parser.values("port");
+    if (ports.isEmpty()) {
+        *error = "No source given: use --port, --synthetic, --replay or --pty";
+        return nullptr;
+    }
+
+    QVector<int> baudRates(ports.size());
+    QVector<int> channels(ports.size(), CLI_CHANNELS);
+    if (parser.value("baud") == "auto") {
+        if (!detectBaudRates(ports, baudRates, channels, error)) {
+            return nullptr;
+        }
+    } else {
+        bool ok;
+        int baudRate = parser.value("baud").toInt(&ok);
+        if (!ok || baudRate <= 0) {
+            *error = QString("Invalid baud rate: %1").arg(parser.value("baud"));
+            return nullptr;
+        }
+        baudRates.fill(baudRate);
+    }
+
+    if (ports.size() == 1) {
+        return new SerialSource(ports.first(), baudRates[0], channels[0]);
+    }
+    MultiSource *multiSource = new MultiSource();
+    for (int i = 0; i < ports.size(); ++i) {
+        multiSource->addSource(new SerialSource(ports[i], baudRates[i], channels[i]));
+    }
+    return multiSource;
+}
+
+int main(int argc, char **argv) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("uart-scope-cli");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Records a UART Scope source to a capture (." CAPTURE_EXTENSION ") or CSV (." CSV_EXTENSION ") file without the UI.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("output", "Output file; the extension selects the format.");
+    parser.addOptions({
+        {{"p", "port"}, "Serial port to read (repeat to merge several boards).", "name"},
+        {{"b", "baud"}, "Baud rate for the serial ports, or \"auto\" to detect it per port.", "rate", QString::number(CLI_DEFAULT_BAUD)},
+        {{"s", "synthetic"}, "Use the synthetic waveform generator."},
+        {{"r", "replay"}, "Convert an existing capture file.", "file"},
+        {"realtime", "Replay at recorded speed instead of as fast as possible."},
+#ifdef Q_OS_UNIX
+        {"pty", "Read from a new pseudo-terminal (its path is printed)."},
+        {"shm", "Also publish the live samples in a POSIX shared-memory ring with this name.", "name"},
+#endif
+        {"serve", "Also publish the live samples on a local socket name or localhost TCP port.", "address"},
+        {{"d", "duration"}, "Stop after this many seconds (default: until interrupted).", "seconds", "0"},
+        {{"i", "interval"}, "Seconds between statistics lines (0 disables them).", "seconds", "1"},
+    });
+    parser.process(app);
+
+    if (parser.positionalArguments().size() != 1) {
+        parser.showHelp(1);
+    }
+
+    QString error;
+    DataSource *source = createSource(parser, &error);
+    if (!source) {
+        fprintf(stderr, "%s\n", qPrintable(error));
+        return 1;
+    }
+
+    SampleServer server;
+#ifdef Q_OS_UNIX
+    SharedRingPublisher ring;
+#endif
+    HeadlessLogger logger(source);
+    if (parser.isSet("serve")) {
+        if (!server.listen(parser.value("serve"), &error)) {
+            fprintf(stderr, "Error listening on %s: %s\n", qPrintable(parser.value("serve")), qPrintable(error));
+            return 1;
+        }
+        logger.setServer(&server);
+        fprintf(stdout, "Serving live data on %s\n", qPrintable(server.address()));
+    }
+    qint64 duration = qRound64(parser.value("duration").toDouble() * 1000);
+    int interval = qRound(parser.value("interval").toDouble() * 1000);
+    if (!logger.start(parser.positionalArguments().first(), duration, interval, &error)) {
+        fprintf(stderr, "Error opening %s: %s\n", qPrintable(source->name()), qPrintable(error));
+        return 1;
+    }
+
+#ifdef Q_OS_UNIX
+    if (PtySource *pty = qobject_cast<PtySource*>(source)) {
+        fprintf(stdout, "Listening on %s\n", qPrintable(pty->slavePath()));
+    }
+#endif
+#ifdef Q_OS_UNIX
+    if (parser.isSet("shm")) {
+        QVector<ChannelScale> scales;
+        for (int i = 0; i < source->channelCount(); ++i) {
+            scales.append(source->scale(i));
+        }
+        if (!ring.open(parser.value("shm"), scales, SHARED_RING_DEFAULT_FRAMES, &error)) {
+            fprintf(stderr, "%s\n", qPrintable(error));
+            return 1;
+        }
+        logger.setSharedRing(&ring);
+        fprintf(stdout, "Sharing samples in shared memory %s\n", qPrintable(ring.name()));
+    }
+#endif
+    fprintf(stdout, "Recording %s to %s\n", qPrintable(source->name()), qPrintable(parser.positionalArguments().first()));
+    fflush(stdout);
+
+    QObject::connect(&logger, &HeadlessLogger::finished, &app, &QCoreApplication::quit);
+
+    // Ctrl+C finishes the file properly instead of killing the process.
+    std::signal(SIGINT, onInterrupt);
+    std::signal(SIGTERM, onInterrupt);
+    QTimer interruptTimer;
+    QObject::connect(&interruptTimer, &QTimer::timeout, [&]() {
+        if (interrupted) {
+            logger.stop();
+        }
+    });
+    interruptTimer.start(100);
+
+    app.exec();
+    return logger.hasFailed() ? 1 : 0;
+}
@@ -0,0 +1,82 @@
+#include <QtMath>
+
+#include "clockmodel.h"
+
+#define CLOCK_MODEL_WARMUP 8
+#define CLOCK_MODEL_MIN_WEIGHT 0.05
+
+ClockModel::ClockModel(void) {
+    reset();
+}
+
+void ClockModel::reset(void) {
+    observations = 0;
+    originFrame = 0;
+    originTime = 0;
+    sum = sumX = sumY = sumXX = sumXY = 0.0;
+    jitterScale = CLOCK_MODEL_MIN_JITTER_NS;
+}
+
+// Sums are kept relative to the latest observation so they stay small no
+// matter how long the session runs.
+void ClockModel::addObservation(qint64 frame, qint64 hostTime) {
+    double weight = 1.0;
+
+    if (observations > 0) {
+        if (observations >= CLOCK_MODEL_WARMUP && isValid()) {
+            double residual = hostTime - timeOf(frame);
+            if (residual > jitterScale) {
+                weight = qMax(CLOCK_MODEL_MIN_WEIGHT, qPow(jitterScale / residual, 2));
+            }
+            jitterScale = qMax(CLOCK_MODEL_MIN_JITTER_NS, 0.95 * jitterScale + 0.05 * qAbs(residual));
+        }
+
+        double dx = frame - originFrame;
+        double dy = hostTime - originTime;
+        sumXY += sum * dx * dy - dx * sumY - dy * sumX;
+        sumXX += sum * dx * dx - 2 * dx * sumX;
+        sumX -= sum * dx;
+        sumY -= sum * dy;
+
+        sum *= CLOCK_MODEL_DECAY;
+        sumX *= CLOCK_MODEL_DECAY;
+        sumY *= CLOCK_MODEL_DECAY;
+        sumXX *= CLOCK_MODEL_DECAY;
+        sumXY *= CLOCK_MODEL_DECAY;
+    }
+
+    originFrame = frame;
+    originTime = hostTime;
+    sum += weight;
+    ++observations;
+}
+
+void ClockModel::fit(double *slope, double *intercept) const {
+    double denominator = sum * sumXX - sumX * sumX;
+    *slope = denominator > 0 ? (sum * sumXY - sumX * sumY) / denominator : 0.0;
+    *intercept = sum > 0 ? (sumY - *slope * sumX) / sum : 0.0;
+}
+
+bool ClockModel::isValid(void) const {
+    double slope, intercept;
+    fit(&slope, &intercept);
+    return observations >= 2 && slope > 0;
+}
+
+double ClockModel::period(void) const {
+    double slope, intercept;
+    fit(&slope, &intercept);
+    return slope;
+}
+
+double ClockModel::timeOf(double frame) const {
+    double slope, intercept;
+    fit(&slope, &intercept);
+    return originTime + intercept + slope * (frame - originFrame);
+}
+
+double ClockModel::frameAt(double hostTime) const {
+    double slope, intercept;
+    fit(&slope, &intercept);
+    return originFrame + (hostTime - originTime - intercept) / slope;
+}
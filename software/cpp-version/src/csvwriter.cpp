@@ -0,0 +1,77 @@
+#include "csvwriter.h"
+
+CsvWriter::CsvWriter(int channels) : channels(channels) {
+}
+
+CsvWriter::~CsvWriter(void) {
+    close(nullptr);
+}
+
+bool CsvWriter::open(const QString &path, const QVector<ChannelScale> &scales, QString *error) {
+    close(nullptr);
+
+    file.setFileName(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (error) {
+            *error = file.errorString();
+        }
+        return false;
+    }
+
+    this->scales = scales;
+    this->scales.resize(channels);
+    buffer = "time_s";
+    for (int i = 0; i < channels; ++i) {
+        buffer += QString(",ch%1").arg(i + 1).toUtf8();
+        if (!this->scales[i].unit.isEmpty()) {
+            buffer += QString(" (%1)").arg(this->scales[i].unit).toUtf8();
+        }
+    }
+    buffer += '\n';
+    buffer.reserve(CSV_FLUSH_BYTES + 4096);
+    return true;
+}
+
+bool CsvWriter::close(QString *error) {
+    if (!file.isOpen()) {
+        return true;
+    }
+
+    bool ok = flush();
+    if (!ok && error) {
+        *error = file.errorString();
+    }
+    file.close();
+    return ok;
+}
+
+bool CsvWriter::append(const int16_t *frames, const qint64 *timestamps, int count) {
+    for (int n = 0; n < count; ++n) {
+        const int16_t *frame = frames + n * channels;
+        buffer += QByteArray::number(timestamps[n] / 1e9, 'f', 6);
+        for (int i = 0; i < channels; ++i) {
+            const ChannelScale &scale = scales[i];
+            buffer += ',';
+            if (scale.gain == 1.0 && scale.offset == 0.0) {
+                buffer += QByteArray::number(frame[i]);
+            } else {
+                buffer += QByteArray::number(frame[i] * scale.gain + scale.offset, 'g', 6);
+            }
+        }
+        buffer += '\n';
+    }
+
+    if (buffer.size() >= CSV_FLUSH_BYTES) {
+        return flush();
+    }
+    return true;
+}
+
+bool CsvWriter::flush(void) {
+    if (buffer.isEmpty()) {
+        return true;
+    }
+    bool ok = file.write(buffer) == buffer.size();
+    buffer.resize(0);
+    return ok;
+}
@@ -0,0 +1,144 @@
+#include "decimation.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DECIMATION_X86 1
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#define DECIMATION_NEON 1
+#include <arm_neon.h>
+#endif
+
+typedef void (*MinMaxKernel)(const int16_t *data, qint64 count, int16_t *min, int16_t *max);
+
+static void minMaxScalar(const int16_t *data, qint64 count, int16_t *min, int16_t *max) {
+    int16_t low = *min;
+    int16_t high = *max;
+    for (qint64 i = 0; i < count; ++i) {
+        low = qMin(low, data[i]);
+        high = qMax(high, data[i]);
+    }
+    *min = low;
+    *max = high;
+}
+
+#ifdef DECIMATION_X86
+__attribute__((target("sse2")))
+static void minMaxSse2(const int16_t *data, qint64 count, int16_t *min, int16_t *max) {
+    qint64 i = 0;
+    if (count >= 8) {
+        __m128i low = _mm_set1_epi16(*min);
+        __m128i high = _mm_set1_epi16(*max);
+        for (; i + 8 <= count; i += 8) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            low = _mm_min_epi16(low, v);
+            high = _mm_max_epi16(high, v);
+        }
+        int16_t lanes[8];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), low);
+        minMaxScalar(lanes, 8, min, max);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), high);
+        minMaxScalar(lanes, 8, min, max);
+    }
+    minMaxScalar(data + i, count - i, min, max);
+}
+
+__attribute__((target("avx2")))
+static void minMaxAvx2(const int16_t *data, qint64 count, int16_t *min, int16_t *max) {
+    qint64 i = 0;
+    if (count >= 16) {
+        __m256i low = _mm256_set1_epi16(*min);
+        __m256i high = _mm256_set1_epi16(*max);
+        for (; i + 16 <= count; i += 16) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+            low = _mm256_min_epi16(low, v);
+            high = _mm256_max_epi16(high, v);
+        }
+        int16_t lanes[16];
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), low);
+        minMaxScalar(lanes, 16, min, max);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), high);
+        minMaxScalar(lanes, 16, min, max);
+    }
+    minMaxSse2(data + i, count - i, min, max);
+}
+#endif
+
+#ifdef DECIMATION_NEON
+static void minMaxNeon(const int16_t *data, qint64 count, int16_t *min, int16_t *max) {
+    qint64 i = 0;
+    if (count >= 8) {
+        int16x8_t low = vdupq_n_s16(*min);
+        int16x8_t high = vdupq_n_s16(*max);
+        for (; i + 8 <= count; i += 8) {
+            int16x8_t v = vld1q_s16(data + i);
+            low = vminq_s16(low, v);
+            high = vmaxq_s16(high, v);
+        }
+        int16_t lanes[8];
+        vst1q_s16(lanes, low);
+        minMaxScalar(lanes, 8, min, max);
+        vst1q_s16(lanes, high);
+        minMaxScalar(lanes, 8, min, max);
+    }
+    minMaxScalar(data + i, count - i, min, max);
+}
+#endif
+
+struct KernelChoice {
+    MinMaxKernel kernel;
+    const char *name;
+};
+
+// Every kernel the CPU can run, widest last.
+struct KernelTable {
+    KernelChoice kernels[3];
+    int count;
+};
+
+static KernelTable supportedKernels(void) {
+    KernelTable table = {{{minMaxScalar, "scalar"}}, 1};
+#if defined(DECIMATION_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) {
+        table.kernels[table.count++] = {minMaxSse2, "sse2"};
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        table.kernels[table.count++] = {minMaxAvx2, "avx2"};
+    }
+#elif defined(DECIMATION_NEON)
+    table.kernels[table.count++] = {minMaxNeon, "neon"};
+#endif
+    return table;
+}
+
+static const KernelTable &kernelTable(void) {
+    static const KernelTable table = supportedKernels();
+    return table;
+}
+
+static const KernelChoice &kernelChoice(void) {
+    static const KernelChoice choice = kernelTable().kernels[kernelTable().count - 1];
+    return choice;
+}
+
+void minMaxCounts(const int16_t *data, qint64 count, int16_t *min, int16_t *max) {
+    kernelChoice().kernel(data, count, min, max);
+}
+
+const char *minMaxKernelName(void) {
+    return kernelChoice().name;
+}
+
+int minMaxKernelCount(void) {
+    return kernelTable().count;
+}
+
+const char *minMaxKernelName(int kernel) {
+    Q_ASSERT(kernel >= 0 && kernel < minMaxKernelCount());
+    return kernelTable().kernels[kernel].name;
+}
+
+void minMaxCountsWith(int kernel, const int16_t *data, qint64 count, int16_t *min, int16_t *max) {
+    Q_ASSERT(kernel >= 0 && kernel < minMaxKernelCount());
+    kernelTable().kernels[kernel].kernel(data, count, min, max);
+}
@@ -0,0 +1,188 @@
+#include <QOpenGLContext>
+#include <QOffscreenSurface>
+#include <QSurfaceFormat>
+#include <QMatrix4x4>
+
+#include "gltraceview.h"
+
+static const char *vertexShaderSource =
+    "attribute highp vec2 position;\n"
+    "uniform highp mat4 projection;\n"
+    "void main() {\n"
+    "    gl_Position = projection * vec4(position, 0.0, 1.0);\n"
+    "}\n";
+
+static const char *fragmentShaderSource =
+    "uniform lowp vec4 color;\n"
+    "void main() {\n"
+    "    gl_FragColor = color;\n"
+    "}\n";
+
+GlTraceView::GlTraceView(QWidget *parent) : QOpenGLWidget(parent), program(nullptr), vertexBuffer(QOpenGLBuffer::VertexBuffer), positionLocation(-1), projectionLocation(-1), colorLocation(-1), glFailed(false), uploadPending(false) {
+    lineWidthRange[0] = lineWidthRange[1] = 1;
+
+    // The plot underneath shows through everywhere no trace is drawn.
+    QSurfaceFormat format = QSurfaceFormat::defaultFormat();
+    format.setAlphaBufferSize(8);
+    setFormat(format);
+    setAttribute(Qt::WA_AlwaysStackOnTop);
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+    setFocusPolicy(Qt::NoFocus);
+}
+
+GlTraceView::~GlTraceView(void) {
+    makeCurrent();
+    releaseGl();
+    doneCurrent();
+}
+
+bool GlTraceView::isSupported(QString *error) {
+    QOpenGLContext context;
+    if (!context.create()) {
+        if (error) {
+            *error = "Could not create an OpenGL context";
+        }
+        return false;
+    }
+
+    QOffscreenSurface surface;
+    surface.setFormat(context.format());
+    surface.create();
+    if (!surface.isValid() || !context.makeCurrent(&surface)) {
+        if (error) {
+            *error = "Could not make the OpenGL context current";
+        }
+        return false;
+    }
+
+    bool supported = context.isOpenGLES() || context.format().majorVersion() >= 2;
+    context.doneCurrent();
+    if (!supported && error) {
+        *error = QString("OpenGL %1.%2 is too old, 2.0 is needed").arg(context.format().majorVersion()).arg(context.format().minorVersion());
+    }
+    return supported;
+}
+
+void GlTraceView::beginFrame(void) {
+    vertices.resize(0);
+    strips.resize(0);
+}
+
+void GlTraceView::addTrace(const QVector<QPointF> &points, const QColor &color, double width) {
+    if (points.size() < 2) {
+        return;
+    }
+    Strip strip;
+    strip.first = vertices.size() / 2;
+    strip.count = points.size();
+    strip.color = color;
+    strip.width = width;
+    strips.append(strip);
+
+    int offset = vertices.size();
+    vertices.resize(offset + 2 * points.size());
+    float *out = vertices.data() + offset;
+    for (const QPointF &point : points) {
+        *out++ = point.x();
+        *out++ = point.y();
+    }
+}
+
+void GlTraceView::endFrame(const QRect &area) {
+    if (glFailed) {
+        return;
+    }
+    drawArea = area;
+    if (geometry() != area) {
+        setGeometry(area);
+    }
+    uploadPending = true;
+    update();
+}
+
+void GlTraceView::initializeGL(void) {
+    initializeOpenGLFunctions();
+    connect(context(), &QOpenGLContext::aboutToBeDestroyed, this, [this]() {
+        makeCurrent();
+        releaseGl();
+        doneCurrent();
+    });
+
+    program = new QOpenGLShaderProgram();
+    if (!program->addShaderFromSourceCode(QOpenGLShader::Vertex, vertexShaderSource)
+        || !program->addShaderFromSourceCode(QOpenGLShader::Fragment, fragmentShaderSource)
+        || !program->link()) {
+        fail(QString("Could not build the trace shaders: %1").arg(program->log()));
+        return;
+    }
+    positionLocation = program->attributeLocation("position");
+    projectionLocation = program->uniformLocation("projection");
+    colorLocation = program->uniformLocation("color");
+
+    if (!vertexBuffer.create()) {
+        fail("Could not create a vertex buffer");
+        return;
+    }
+    vertexBuffer.setUsagePattern(QOpenGLBuffer::DynamicDraw);
+
+    glGetFloatv(GL_ALIASED_LINE_WIDTH_RANGE, lineWidthRange);
+    uploadPending = true;
+}
+
+void GlTraceView::paintGL(void) {
+    glClearColor(0, 0, 0, 0);
+    glClear(GL_COLOR_BUFFER_BIT);
+    if (glFailed || !program || strips.isEmpty()) {
+        return;
+    }
+
+    // The buffer only grows, so a steady frame size just overwrites it.
+    vertexBuffer.bind();
+    if (uploadPending) {
+        int bytes = vertices.size() * sizeof(float);
+        if (vertexBuffer.size() < bytes) {
+            vertexBuffer.allocate(vertices.constData(), bytes);
+        } else {
+            vertexBuffer.write(0, vertices.constData(), bytes);
+        }
+        uploadPending = false;
+    }
+
+    // Vertices are in plot pixels; sample at pixel centres like QPainter's
+    // non-antialiased lines.
+    QMatrix4x4 projection;
+    projection.ortho(drawArea.left(), drawArea.left() + drawArea.width(), drawArea.top() + drawArea.height(), drawArea.top(), -1, 1);
+    projection.translate(0.5, 0.5);
+
+    program->bind();
+    program->setUniformValue(projectionLocation, projection);
+    program->enableAttributeArray(positionLocation);
+    program->setAttributeBuffer(positionLocation, GL_FLOAT, 0, 2);
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    for (const Strip &strip : strips) {
+        // The widget is composited with premultiplied alpha.
+        float alpha = strip.color.alphaF();
+        program->setUniformValue(colorLocation, strip.color.redF() * alpha, strip.color.greenF() * alpha, strip.color.blueF() * alpha, alpha);
+        glLineWidth(qBound(lineWidthRange[0], strip.width, qMin(lineWidthRange[1], float(GL_TRACE_VIEW_MAX_LINE_WIDTH))));
+        glDrawArrays(GL_LINE_STRIP, strip.first, strip.count);
+    }
+    glDisable(GL_BLEND);
+
+    program->disableAttributeArray(positionLocation);
+    program->release();
+    vertexBuffer.release();
+}
+
+void GlTraceView::releaseGl(void) {
+    vertexBuffer.destroy();
+    delete program;
+    program = nullptr;
+}
+
+void GlTraceView::fail(const QString &error) {
+    glFailed = true;
+    releaseGl();
+    emit failed(error);
+}
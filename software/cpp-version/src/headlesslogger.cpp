@@ -0,0 +1,152 @@
+#include <QFileInfo>
+#include <cstdio>
+
+#include "headlesslogger.h"
+
+HeadlessLogger::HeadlessLogger(DataSource *source, QObject *parent) : QObject(parent), source(source), reader(nullptr), captureWriter(nullptr), csvWriter(nullptr), server(nullptr), duration(0), frames(0), statsFrames(0), statsTime(0), running(false), failed(false) {
+#ifdef Q_OS_UNIX
+    ring = nullptr;
+#endif
+    connect(&drainTimer, &QTimer::timeout, this, &HeadlessLogger::drain);
+    connect(&statsTimer, &QTimer::timeout, this, &HeadlessLogger::printStats);
+}
+
+HeadlessLogger::~HeadlessLogger(void) {
+    stop();
+    delete reader;
+    delete captureWriter;
+    delete csvWriter;
+    delete source;
+}
+
+bool HeadlessLogger::start(const QString &path, qint64 durationMsecs, int statsMsecs, QString *error) {
+    epoch.start();
+    reader = new SourceReader(source, &epoch);
+    if (!reader->open(error)) {
+        return false;
+    }
+
+    int channels = source->channelCount();
+    QVector<ChannelScale> scales;
+    for (int i = 0; i < channels; ++i) {
+        scales.append(source->scale(i));
+    }
+
+    if (server) {
+        server->setScales(scales);
+    }
+
+    bool opened;
+    if (QFileInfo(path).suffix().compare(CSV_EXTENSION, Qt::CaseInsensitive) == 0) {
+        csvWriter = new CsvWriter(channels);
+        opened = csvWriter->open(path, scales, error);
+    } else {
+        captureWriter = new CaptureWriter(channels);
+        captureWriter->setBlocking(!source->isLive());
+        connect(captureWriter, &CaptureWriter::writeError, this, &HeadlessLogger::fail);
+        opened = captureWriter->open(path, scales, error);
+    }
+    if (!opened) {
+        reader->close();
+        return false;
+    }
+
+    duration = durationMsecs;
+    frames = 0;
+    statsFrames = 0;
+    statsTime = 0;
+    running = true;
+
+    drainTimer.start(LOGGER_DRAIN_MS);
+    if (statsMsecs > 0) {
+        statsTimer.start(statsMsecs);
+    }
+    return true;
+}
+
+void HeadlessLogger::stop(void) {
+    if (!running) {
+        return;
+    }
+    running = false;
+    drainTimer.stop();
+    statsTimer.stop();
+
+    takeBlocks();
+    reader->close();
+    takeBlocks();
+
+    if (captureWriter) {
+        captureWriter->close();
+    }
+    if (csvWriter) {
+        QString error;
+        if (!csvWriter->close(&error)) {
+            fprintf(stderr, "Error writing CSV file: %s\n", qPrintable(error));
+        }
+    }
+
+    printStats();
+    emit finished();
+}
+
+// At most one queue's worth per call: a replay refills the queue as fast as it
+// is emptied, and the event loop has to get a turn in between.
+bool HeadlessLogger::takeBlocks(void) {
+    for (int taken = 0; taken < READER_QUEUE_BLOCKS && reader->takeBlock(block); ++taken) {
+        if (captureWriter) {
+            int channels = source->channelCount();
+            for (int n = 0; n < block.count; ++n) {
+                captureWriter->append(block.frames.constData() + n * channels, block.timestamps[n]);
+            }
+        } else if (!csvWriter->append(block.frames.constData(), block.timestamps.constData(), block.count)) {
+            return false;
+        }
+        if (server) {
+            server->publish(block.frames.constData(), block.timestamps.constData(), block.count, source->channelCount());
+        }
+#ifdef Q_OS_UNIX
+        if (ring) {
+            ring->publish(block.frames.constData(), block.timestamps.constData(), block.count, source->channelCount());
+        }
+#endif
+        frames += block.count;
+    }
+    return true;
+}
+
+void HeadlessLogger::drain(void) {
+    if (!takeBlocks()) {
+        fail(QString("Error writing CSV file: %1").arg(csvWriter->errorString()));
+        return;
+    }
+
+    if (reader->atEnd() || (duration > 0 && epoch.elapsed() >= duration)) {
+        stop();
+    }
+}
+
+void HeadlessLogger::printStats(void) {
+    qint64 now = epoch.nsecsElapsed();
+    double interval = (now - statsTime) / 1e9;
+    double rate = interval > 0 ? (frames - statsFrames) / interval : 0;
+    statsFrames = frames;
+    statsTime = now;
+
+    SourceStats sourceStats = source->stats();
+    qint64 writerDropped = captureWriter ? captureWriter->droppedFrames() : 0;
+    fprintf(stdout, "%8.1f s  %12lld frames  %10.0f frames/s  %lld bytes  %lld parse errors  dropped %lld bytes, %lld (source) %lld (reader) %lld (writer)",
+            now / 1e9, (long long)frames, rate, (long long)sourceStats.bytes, (long long)sourceStats.parseErrors, (long long)sourceStats.droppedBytes,
+            (long long)sourceStats.droppedFrames, (long long)reader->droppedFrames(), (long long)writerDropped);
+    if (server) {
+        fprintf(stdout, " %lld (%d clients)", (long long)server->droppedFrames(), server->subscriberCount());
+    }
+    fprintf(stdout, "\n");
+    fflush(stdout);
+}
+
+void HeadlessLogger::fail(const QString &message) {
+    fprintf(stderr, "%s\n", qPrintable(message));
+    failed = true;
+    stop();
+}
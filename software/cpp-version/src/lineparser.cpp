@@ -0,0 +1,118 @@
+#include <cstring>
+
+#include "lineparser.h"
+
+static inline bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+LineParser::LineParser(int channels) : channels(channels), buffer(PARSER_BUFFER_LIMIT + PARSER_READ_SIZE, '\0'), readPos(0), writePos(0), errors(0), dropped(0) {
+}
+
+void LineParser::reset(void) {
+    readPos = 0;
+    writePos = 0;
+}
+
+char *LineParser::reserve(int size) {
+    if (writePos + size > buffer.size()) {
+        char *data = buffer.data();
+        memmove(data, data + readPos, writePos - readPos);
+        writePos -= readPos;
+        readPos = 0;
+        if (writePos + size > buffer.size()) {
+            buffer.resize(writePos + size);
+        }
+    }
+    return buffer.data() + writePos;
+}
+
+void LineParser::commit(int size) {
+    writePos += size;
+
+    if (bufferedBytes() > PARSER_BUFFER_LIMIT) {
+        int keep = PARSER_BUFFER_LIMIT / 2;
+        dropped += bufferedBytes() - keep;
+        readPos = writePos - keep;
+    }
+}
+
+void LineParser::feed(const char *data, qint64 size) {
+    while (size > 0) {
+        int chunk = int(qMin<qint64>(size, PARSER_READ_SIZE));
+        memcpy(reserve(chunk), data, chunk);
+        commit(chunk);
+        data += chunk;
+        size -= chunk;
+    }
+}
+
+int LineParser::takeFrames(int16_t *frames, int maxFrames) {
+    int count = 0;
+    const char *data = buffer.constData();
+
+    while (count < maxFrames) {
+        const char *begin = data + readPos;
+        const char *newline = static_cast<const char*>(memchr(begin, '\n', writePos - readPos));
+        if (!newline) {
+            break;
+        }
+        readPos = newline - data + 1;
+
+        const char *end = newline;
+        while (begin < end && isBlank(*begin)) {
+            ++begin;
+        }
+        while (end > begin && isBlank(end[-1])) {
+            --end;
+        }
+        if (begin == end) {
+            continue;
+        }
+
+        if (parseLine(begin, end, frames + count * channels)) {
+            ++count;
+        } else {
+            ++errors;
+        }
+    }
+
+    return count;
+}
+
+bool LineParser::parseLine(const char *begin, const char *end, int16_t *frame) const {
+    const char *p = begin;
+    for (int i = 0; i < channels; ++i) {
+        if (i > 0) {
+            if (p == end || *p != '\t') {
+                return false;
+            }
+            ++p;
+        }
+
+        while (p < end && *p == ' ') {
+            ++p;
+        }
+        bool negative = p < end && *p == '-';
+        if (p < end && (*p == '-' || *p == '+')) {
+            ++p;
+        }
+
+        const char *digits = p;
+        int value = 0;
+        while (p < end && *p >= '0' && *p <= '9') {
+            value = qMin(value * 10 + (*p - '0'), 1 << 16);
+            ++p;
+        }
+        if (p == digits) {
+            return false;
+        }
+        while (p < end && *p == ' ') {
+            ++p;
+        }
+
+        value = negative ? -value : value;
+        frame[i] = static_cast<int16_t>(qBound(INT16_MIN, value, INT16_MAX));
+    }
+    return p == end;
+}
@@ -4,120 +4,247 @@
 #include <QHBoxLayout>
 #include <QVBoxLayout>
 #include <QGridLayout>
+#include <QtMath>
+#include <QFileDialog>
+#include <QDateTime>
+#include <QInputDialog>
+#include <QSignalBlocker>
+#include <QGuiApplication>
+#include <QScreen>
 
 #include "mainwindow.h"
-
-MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), serialPort(nullptr), baudRate(0), isAcquiring(false), isPaused(false), plotManager(nullptr) {
+#include "serialsource.h"
+#include "syntheticsource.h"
+#include "multisource.h"
+#ifdef Q_OS_UNIX
+#include "ptysource.h"
+#endif
+
+MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), baudRate(0), autoBaud(false), detectedChannels(0), baudDetector(nullptr), channelCount(CHANNELS), isAcquiring(false), isPaused(false), sampleStore(nullptr), captureWriter(nullptr), acquisition(nullptr), sampleServer(nullptr), phosphor(nullptr), plotManager(nullptr), spectrogram(nullptr), statsMonitor(nullptr) {
     setWindowTitle("UART Scope");
     setupUi();
     setupSerial();
     
-    plotManager = new PlotManager(graphicsView, CHANNELS, MAX_PLOT_POINTS, this);
+    plotManager = new PlotManager(graphicsView, channelCount, MAX_PLOT_POINTS, this);
     plotManager->setupPlot();
+    connect(plotManager, &PlotManager::viewRangeChanged, renderScheduler, &RenderScheduler::requestFrame);
+    connect(plotManager, &PlotManager::openGlFailed, this, &MainWindow::openGlFailed);
     
     colors = plotManager->getColors();
     plotDataItems = plotManager->getPlotItems();
+    buildChannelButtons();
     
-    plotData.resize(CHANNELS);
-    for (int i = 0; i < CHANNELS; ++i) {
-        plotData[i].resize(MAX_PLOT_POINTS);
-        plotData[i].fill(0);
-    }
+    spectrogram = new Spectrogram(spectrogramView, this);
+    spectrogram->setChannels(channelCount, colors);
     
-    xData.resize(MAX_PLOT_POINTS);
-    for (int i = 0; i < MAX_PLOT_POINTS; ++i) {
-        xData[i] = i;
-    }
+    createSinks();
+    acquisition = new Acquisition(channelCount, sampleStore, captureWriter, this);
+    sampleServer = new SampleServer(this);
+    acquisition->setServer(sampleServer);
+    phosphor = new Phosphor(this);
+    acquisition->setPhosphor(phosphor);
+#ifdef Q_OS_UNIX
+    acquisition->setSharedRing(&sharedRing);
+#endif
+    
+    statsMonitor = new StatsMonitor(acquisition, plotManager, renderScheduler, this);
+    connect(statsMonitor, &StatsMonitor::updated, this, &MainWindow::showStats);
     
     pauseResumeButton->setEnabled(false);
     clearButton->setEnabled(false);
 }
 
 MainWindow::~MainWindow(void) {
-    if (serialPort) {
-        if (serialPort->isOpen()) {
-            serialPort->close();
-        }
-        delete serialPort;
+    if (baudDetector) {
+        baudDetector->wait();
     }
-    delete timer;
+    captureWriter->close();
+    acquisition->stop();
+
+    portWatcher->stop();
 
-    serialScanTimer->stop();
-    delete serialScanTimer;
+    delete acquisition;
+    delete sampleStore;
 }
 
-void MainWindow::updateScaleValue(int value) {
-    scaleXValueLabel->setText(QString("%1 points").arg(value));
+void MainWindow::createSinks(void) {
+    sampleStore = new SampleStore(channelCount, HISTORY_POINTS);
+    
+    captureWriter = new CaptureWriter(channelCount, this);
+    connect(captureWriter, &CaptureWriter::writeError, this, [=](const QString &message) {
+        QMessageBox::critical(this, "Recording Error", QString("Error writing capture file: %1").arg(message));
+    });
 }
 
-void MainWindow::autoPosition(void) {
-    plotManager->autoPosition();
+// Sources that merge several devices, or captures recorded from them, bring
+// more channels than the default; the store, writer, plot and buttons follow.
+void MainWindow::setChannelCount(int channels) {
+    if (channels <= 0 || channels == channelCount) {
+        return;
+    }
+    
+    stopRecording();
+    delete captureWriter;
+    delete sampleStore;
+    
+    channelCount = channels;
+    createSinks();
+    acquisition->setSinks(channelCount, sampleStore, captureWriter);
+    
+    plotManager->setChannelCount(channelCount);
+    plotDataItems = plotManager->getPlotItems();
+    buildChannelButtons();
+    spectrogram->setChannels(channelCount, colors);
+    if (phosphor->isOpen()) {
+        phosphor->open(channelCount);
+    }
 }
 
-void MainWindow::startSerialRead(void) {
-    if (serialPort && baudRate > 0) {
-        isAcquiring = true;
+void MainWindow::buildChannelButtons(void) {
+    QVector<bool> checked;
+    for (QPushButton *button : channelButtons) {
+        checked.append(button->isChecked());
+        delete button;
+    }
+    channelButtons.clear();
+    
+    for (int i = 0; i < channelCount; ++i) {
+        QPushButton *button = new QPushButton(QString("Channel %1").arg(i + 1));
+        button->setCheckable(true);
+        button->setChecked(i < checked.size() ? checked[i] : i == 0);
+        connect(button, &QPushButton::toggled, [=](bool checked) { toggleChannel(i, checked); });
+        channelButtons.append(button);
+        channelsGridLayout->addWidget(button, i / 2, i % 2);
+        toggleChannel(i, button->isChecked());
     }
 }
 
+// The slider is logarithmic so it can span from a few points up to the whole history.
+static qint64 sliderToPoints(int position) {
+    double fraction = double(position) / SCALE_SLIDER_STEPS;
+    return qRound64(MIN_PLOT_POINTS * qPow(double(HISTORY_POINTS) / MIN_PLOT_POINTS, fraction));
+}
+
+static int pointsToSlider(qint64 points) {
+    return qRound(SCALE_SLIDER_STEPS * qLn(double(points) / MIN_PLOT_POINTS) / qLn(double(HISTORY_POINTS) / MIN_PLOT_POINTS));
+}
+
+qint64 MainWindow::visiblePoints(void) const {
+    return sliderToPoints(scaleXSlider->value());
+}
+
+static QString formatDuration(double seconds) {
+    if (seconds >= 1.0) {
+        return QString("%1 s").arg(seconds, 0, 'g', 4);
+    }
+    if (seconds >= 1e-3) {
+        return QString("%1 ms").arg(seconds * 1e3, 0, 'g', 4);
+    }
+    return QString("%1 us").arg(seconds * 1e6, 0, 'g', 4);
+}
+
+void MainWindow::updateScaleValue(int value) {
+    qint64 points = sliderToPoints(value);
+    double origin, period;
+    if (acquisition && acquisition->sampleTimeBase(&origin, &period)) {
+        scaleXValueLabel->setText(QString("%1 points (%2)").arg(points).arg(formatDuration(points * period)));
+    } else {
+        scaleXValueLabel->setText(QString("%1 points").arg(points));
+    }
+}
+
+void MainWindow::autoPosition(void) {
+    plotManager->autoPosition();
+}
+
+// Pause only freezes the view: live sources keep streaming into the history
+// and the recording, so nothing is lost and the port is not reopened (which
+// would reset the board). A replay has no device behind it and really stops.
 void MainWindow::pauseResume(void) {
     isPaused = !isPaused;
     if (isPaused) {
         pauseResumeButton->setText("Resume");
-        timer->stop();
-        if (serialPort && serialPort->isOpen()) {
-            serialPort->close();
+        plotManager->setFollowLive(false);
+        if (replaySource()) {
+            acquisition->pause();
+        } else {
+            statusBar()->showMessage(QString("View paused, still acquiring from %1").arg(acquisition->source()->name()));
         }
     } else {
         pauseResumeButton->setText("Pause");
 
-        serialData.clear();
-
-        if (serialPort && baudRate > 0) {
-            if (serialPort->open(QIODevice::ReadWrite)) {
-                timer->start();
-                startSerialRead();
-                isAcquiring = true;
-            } else {
-                QMessageBox::critical(this, "Serial Port Error", QString("Error reopening serial port: %1").arg(serialPort->errorString()));
-                isPaused = true;
-                pauseResumeButton->setText("Resume");
-                return;
-            }
+        QString error;
+        if (replaySource() && !acquisition->resume(&error)) {
+            QMessageBox::critical(this, "Data Source Error", QString("Error reopening %1: %2").arg(acquisition->source()->name(), error));
+            isPaused = true;
+            pauseResumeButton->setText("Resume");
+            return;
         }
+        statusBar()->showMessage(QString(replaySource() ? "Replaying %1" : "Acquiring from %1").arg(acquisition->source()->name()));
+        plotManager->setFollowLive(true);
+        renderScheduler->requestFrame();
     }
 }
 
 void MainWindow::clearPlot(void) {
-    for (int i = 0; i < CHANNELS; ++i) {
-        plotData[i].fill(0, MAX_PLOT_POINTS);
-    }
-    
-    QVector<bool> channelVisibility;
-    for (int i = 0; i < CHANNELS; ++i) {
-        channelVisibility.append(channelButtons[i]->isChecked());
-    }
-    
-    int currentPlotLength = scaleXSlider->value();
-    plotManager->updatePlotData(plotData, xData, currentPlotLength, channelVisibility);
+    sampleStore->clear();
+    phosphor->clear();
+    spectrogram->clear();
+    renderScheduler->requestFrame();
 }
 
 void MainWindow::toggleChannel(int index, bool checked) {
     if (checked) {
-        QString styleSheet = QString("background-color: %1; color: white;").arg(colors[index].name());
+        QString styleSheet = QString("background-color: %1; color: white;").arg(colors[index % colors.size()].name());
         channelButtons[index]->setStyleSheet(styleSheet);
         plotDataItems[index]->setVisible(true);
     } else {
         channelButtons[index]->setStyleSheet("background-color: rgb(45, 45, 45); color: white;");
         plotDataItems[index]->setVisible(false);
     }
-    graphicsView->replot();
+    renderScheduler->requestFrame();
+}
+
+void MainWindow::selectSourceType(int index) {
+    baudRates->setEnabled(index == SourceSerial || index == SourceMultiSerial);
+    serialPorts->setEnabled(index == SourceSerial);
+    serialPorts->setVisible(index != SourceMultiSerial);
+    multiPorts->setVisible(index == SourceMultiSerial);
+    if (index == SourceSerial || index == SourceMultiSerial) {
+        portWatcher->requestScan();
+    }
+    updateStartButton();
+}
+
+void MainWindow::updateStartButton(void) {
+    switch (sourceTypes->currentIndex()) {
+    case SourceSerial:
+        startButton->setEnabled((baudRate > 0 || autoBaud) && serialPorts->currentIndex() > 0 && !baudDetector);
+        break;
+    case SourceMultiSerial:
+        startButton->setEnabled(baudRate > 0 && checkedPorts().size() >= 2 && checkedPorts().size() <= MULTI_MAX_PORTS);
+        break;
+    default:
+        startButton->setEnabled(true);
+        break;
+    }
+}
+
+QStringList MainWindow::checkedPorts(void) const {
+    QStringList ports;
+    for (int i = 0; i < multiPorts->count(); ++i) {
+        if (multiPorts->item(i)->checkState() == Qt::Checked) {
+            ports << multiPorts->item(i)->text();
+        }
+    }
+    return ports;
 }
 
 void MainWindow::selectBaudRate(int index) {
-    if (index == 0) {
+    autoBaud = index == 1;
+    if (index <= 1) {
         baudRate = 0;
-        startButton->setEnabled(false);
+        updateStartButton();
         return;
     }
     
@@ -131,27 +258,25 @@ void MainWindow::selectBaudRate(int index) {
         qDebug() << "Error converting baud rate";
     }
 
-    if (serialPort && serialPort->isOpen()) {
-        serialPort->setBaudRate(baudRate);
-        if (!isPaused) {
-            timer->start();
-        }
+    SerialSource *serialSource = qobject_cast<SerialSource*>(acquisition->source());
+    if (serialSource && serialSource->isOpen()) {
+        serialSource->setBaudRate(baudRate);
     }
     
-    if (serialPorts->currentIndex() > 0) {
-        startButton->setEnabled(true);
-    }
+    updateStartButton();
 }
 
 void MainWindow::selectSerialPort(int index) {
     if (index == 0) {
-        startButton->setEnabled(false);
+        portName.clear();
+        updateStartButton();
         return;
     }
     
-    QString portName = serialPorts->itemText(index);
-    
-    if (baudRate <= 0) {
+    if (autoBaud) {
+        baudRate = 0;
+        baudRates->setItemText(1, "Auto detect");
+    } else if (baudRate <= 0) {
         QMessageBox::warning(this, "Missing Baud Rate", "Please select a baud rate before selecting a serial port.");
         serialPorts->blockSignals(true);
         serialPorts->setCurrentIndex(0);
@@ -159,75 +284,326 @@ void MainWindow::selectSerialPort(int index) {
         return;
     }
     
-    if (serialPort && serialPort->isOpen()) {
-        serialPort->close();
+    portName = serialPorts->itemText(index);
+    updateStartButton();
+}
+
+DataSource *MainWindow::createSource(void) {
+    switch (sourceTypes->currentIndex()) {
+    case SourceSerial:
+        if (portName.isEmpty() || baudRate <= 0) {
+            return nullptr;
+        }
+        return new SerialSource(portName, baudRate, autoBaud && detectedChannels > 0 ? detectedChannels : CHANNELS);
+    case SourceMultiSerial: {
+        QStringList ports = checkedPorts();
+        if (ports.isEmpty() || ports.size() > MULTI_MAX_PORTS || baudRate <= 0) {
+            return nullptr;
+        }
+        MultiSource *multiSource = new MultiSource();
+        for (const QString &port : ports) {
+            multiSource->addSource(new SerialSource(port, baudRate, CHANNELS));
+        }
+        return multiSource;
     }
-    
-    if (!serialPort) {
-        serialPort = new QSerialPort(this);
+    case SourceSynthetic:
+        return new SyntheticSource(CHANNELS);
+#ifdef Q_OS_UNIX
+    case SourcePty:
+        return new PtySource(CHANNELS);
+#endif
+    default:
+        return nullptr;
     }
+}
+
+// Detection runs in the background; acquisition starts once it has locked.
+void MainWindow::detectBaudRate(void) {
+    baudDetector = new BaudDetector(portName, this);
+    connect(baudDetector, &QThread::finished, this, &MainWindow::baudDetectionFinished);
+    updateStartButton();
+    statusBar()->showMessage(QString("Detecting baud rate on %1...").arg(portName));
+    baudDetector->start();
+}
+
+void MainWindow::baudDetectionFinished(void) {
+    BaudDetector *detector = baudDetector;
+    baudDetector = nullptr;
+    detector->deleteLater();
+    updateStartButton();
     
-    serialPort->setPortName(portName);
-    serialPort->setBaudRate(baudRate);
-    serialPort->setDataBits(QSerialPort::Data8);
-    serialPort->setParity(QSerialPort::NoParity);
-    serialPort->setStopBits(QSerialPort::OneStop);
-    serialPort->setFlowControl(QSerialPort::NoFlowControl);
+    if (detector->baudRate() <= 0 || detector->score() < BAUD_DETECT_MIN_SCORE) {
+        statusBar()->showMessage("Ready");
+        QMessageBox::warning(this, "Baud Rate Detection", QString("Could not detect the baud rate on %1: %2").arg(portName, detector->errorString()));
+        return;
+    }
     
-    startButton->setEnabled(true);
+    baudRate = detector->baudRate();
+    detectedChannels = detector->channelCount();
+    baudRates->setItemText(1, QString("Auto (%1)").arg(baudRate));
+    startAcquisition();
+}
+
+CaptureReplay *MainWindow::replaySource(void) const {
+    return qobject_cast<CaptureReplay*>(acquisition->source());
 }
 
 void MainWindow::startAcquisition(void) {
-    if (!serialPort || baudRate <= 0) {
+    if (isAcquiring) {
+        QMessageBox::warning(this, "Already Acquiring", "Data acquisition is already running.");
+        return;
+    }
+    
+    if (sourceTypes->currentIndex() == SourceSerial && autoBaud && baudRate <= 0 && !portName.isEmpty()) {
+        detectBaudRate();
+        return;
+    }
+    
+    DataSource *source = createSource();
+    if (!source) {
         QMessageBox::warning(this, "Missing Serial Port or Baud Rate", "Please select both a serial port and a baud rate before starting acquisition.");
         return;
     }
+    acquisition->setSource(source);
     
-    if (!isAcquiring) {
-        try {
-            if (serialPort->isOpen()) {
-                serialPort->close();
-            }
-            
-            if (!serialPort->open(QIODevice::ReadWrite)) {
-                QMessageBox::critical(this, "Serial Port Error", QString("Error opening serial port: %1").arg(serialPort->errorString()));
-                stopAcquisition();
-                return;
-            }
-            
-            timer->start(33);
-            startSerialRead();
-            isAcquiring = true;
-            
-            pauseResumeButton->setEnabled(true);
-            clearButton->setEnabled(true);
-            
-            serialData.clear();
-            
-        } catch (const std::exception& e) {
-            QMessageBox::critical(this, "Serial Port Error", QString("Error: %1").arg(e.what()));
+    try {
+        QString error;
+        if (!acquisition->start(&error)) {
+            QMessageBox::critical(this, "Data Source Error", QString("Error opening %1: %2").arg(source->name(), error));
             stopAcquisition();
+            return;
         }
-    } else {
-        QMessageBox::warning(this, "Already Acquiring", "Data acquisition is already running.");
+        setChannelCount(source->channelCount());
+        
+        renderScheduler->start();
+        statsMonitor->start();
+        portWatcher->setPaused(true);
+        isAcquiring = true;
+        
+        pauseResumeButton->setEnabled(true);
+        clearButton->setEnabled(true);
+        recordButton->setEnabled(true);
+        
+        statusBar()->showMessage(QString("Acquiring from %1").arg(source->name()));
+        
+    } catch (const std::exception& e) {
+        QMessageBox::critical(this, "Data Source Error", QString("Error: %1").arg(e.what()));
+        stopAcquisition();
     }
 }
 
 void MainWindow::stopAcquisition(void) {
-    if (serialPort) {
-        timer->stop();
-        if (serialPort->isOpen()) {
-            serialPort->close();
-        }
+    if (acquisition->source()) {
+        renderScheduler->stop();
+        statsMonitor->stop();
+        statsLabel->clear();
+        statsLabel->setToolTip(QString());
+        acquisition->stop();
+        portWatcher->setPaused(false);
+        replaySpeeds->setEnabled(false);
+        replayPosition->setEnabled(false);
         isAcquiring = false;
+        isPaused = false;
+        pauseResumeButton->setText("Pause");
+        pauseResumeButton->setChecked(false);
         pauseResumeButton->setEnabled(false);
         clearButton->setEnabled(false);
+        stopRecording();
+        recordButton->setEnabled(false);
         
         plotManager->clearPlot();
-        for (int i = 0; i < CHANNELS; ++i) {
-            plotData[i].fill(0, MAX_PLOT_POINTS);
+        sampleStore->clear();
+        phosphor->clear();
+        spectrogram->clear();
+        statusBar()->showMessage("Ready");
+    }
+}
+
+void MainWindow::toggleRecording(bool checked) {
+    if (!checked) {
+        stopRecording();
+        return;
+    }
+    
+    QString defaultName = QDateTime::currentDateTime().toString("'capture-'yyyyMMdd-hhmmss'." CAPTURE_EXTENSION "'");
+    QString path = QFileDialog::getSaveFileName(this, "Record Capture", defaultName, "Capture files (*." CAPTURE_EXTENSION ")");
+    if (path.isEmpty()) {
+        recordButton->setChecked(false);
+        return;
+    }
+    
+    QVector<ChannelScale> scales;
+    for (int i = 0; i < channelCount; ++i) {
+        scales.append(sampleStore->scale(i));
+    }
+    
+    QString error;
+    if (!captureWriter->open(path, scales, &error)) {
+        QMessageBox::critical(this, "Recording Error", QString("Error creating capture file: %1").arg(error));
+        recordButton->setChecked(false);
+        return;
+    }
+    
+    recordButton->setText("Stop Recording");
+}
+
+void MainWindow::stopRecording(void) {
+    captureWriter->close();
+    recordButton->setChecked(false);
+    recordButton->setText("Record");
+}
+
+void MainWindow::toggleSharing(bool checked) {
+    if (!checked) {
+        sampleServer->close();
+        shareButton->setText("Share Live Data");
+        return;
+    }
+    
+    bool ok;
+    QString address = QInputDialog::getText(this, "Share Live Data", "Local socket name or TCP port:", QLineEdit::Normal, SERVER_DEFAULT_NAME, &ok).trimmed();
+    if (!ok || address.isEmpty()) {
+        shareButton->setChecked(false);
+        return;
+    }
+    
+    QString error;
+    if (!sampleServer->listen(address, &error)) {
+        QMessageBox::critical(this, "Sharing Error", QString("Error listening on %1: %2").arg(address, error));
+        shareButton->setChecked(false);
+        return;
+    }
+    
+    shareButton->setText("Stop Sharing");
+    statusBar()->showMessage(QString("Sharing live data on %1").arg(sampleServer->address()));
+}
+
+void MainWindow::toggleOpenGl(bool checked) {
+    QString error;
+    if (!plotManager->setOpenGl(checked, &error)) {
+        openGlFailed(error);
+        return;
+    }
+    statusBar()->showMessage(checked ? "Drawing traces with OpenGL" : "Drawing traces with QPainter");
+}
+
+// The plot is already back on QPainter; just stop offering OpenGL.
+void MainWindow::openGlFailed(const QString &error) {
+    QSignalBlocker blocker(openGlButton);
+    openGlButton->setChecked(false);
+    openGlButton->setEnabled(false);
+    openGlButton->setToolTip(QString("OpenGL unavailable: %1").arg(error));
+    statusBar()->showMessage(QString("OpenGL unavailable, drawing traces with QPainter: %1").arg(error));
+}
+
+// Decay shift per persistence mode, see Phosphor::setDecay(); with counts
+// fading every 40 ms these give half-lives of about 0.2 s, 1 s and 4 s.
+static const int persistenceDecay[] = { 0, 3, 5, 7, 0 };
+
+void MainWindow::selectPersistence(int index) {
+    if (index <= 0) {
+        plotManager->setPersistence(nullptr);
+        phosphor->close();
+    } else {
+        phosphor->setDecay(persistenceDecay[index]);
+        if (!phosphor->isOpen()) {
+            phosphor->open(channelCount);
+            plotManager->setPersistence(phosphor);
         }
     }
+    renderScheduler->requestFrame();
+}
+
+// The waterfall starts over each time it is shown.
+void MainWindow::toggleSpectrogram(bool checked) {
+    spectrogramView->setVisible(checked);
+    if (checked) {
+        spectrogram->clear();
+    }
+    renderScheduler->requestFrame();
+}
+
+#ifdef Q_OS_UNIX
+void MainWindow::toggleSharedMemory(bool checked) {
+    if (!checked) {
+        sharedRing.close();
+        sharedMemoryButton->setText("Share Memory");
+        return;
+    }
+    
+    QVector<ChannelScale> scales;
+    for (int i = 0; i < channelCount; ++i) {
+        scales.append(sampleStore->scale(i));
+    }
+    
+    QString error;
+    if (!sharedRing.open(SHARED_RING_DEFAULT_NAME, scales, SHARED_RING_DEFAULT_FRAMES, &error)) {
+        QMessageBox::critical(this, "Sharing Error", error);
+        sharedMemoryButton->setChecked(false);
+        return;
+    }
+    
+    sharedMemoryButton->setText("Stop Sharing Memory");
+    statusBar()->showMessage(QString("Sharing samples in shared memory %1").arg(sharedRing.name()));
+}
+#endif
+
+void MainWindow::openCapture(void) {
+    QString path = QFileDialog::getOpenFileName(this, "Open Capture", QString(), "Capture files (*." CAPTURE_EXTENSION ")");
+    if (path.isEmpty()) {
+        return;
+    }
+    
+    if (isAcquiring) {
+        stopAcquisition();
+    }
+    
+    CaptureReplay *replay = new CaptureReplay(path);
+    acquisition->setSource(replay);
+    
+    QString error;
+    if (!acquisition->start(&error)) {
+        QMessageBox::critical(this, "Replay Error", QString("Error opening capture file: %1").arg(error));
+        acquisition->setSource(nullptr);
+        return;
+    }
+    
+    setChannelCount(replay->channelCount());
+    sampleStore->clear();
+    selectReplaySpeed(replaySpeeds->currentIndex());
+    plotManager->setFollowLive(true);
+    
+    pauseResumeButton->setEnabled(true);
+    clearButton->setEnabled(true);
+    recordButton->setEnabled(true);
+    replaySpeeds->setEnabled(true);
+    replayPosition->setEnabled(true);
+    replayPosition->setValue(0);
+    
+    isAcquiring = true;
+    renderScheduler->start();
+    statsMonitor->start();
+    statusBar()->showMessage(QString("Replaying %1").arg(replay->name()));
+}
+
+void MainWindow::selectReplaySpeed(int index) {
+    static const double speeds[] = { 1.0, 10.0, 100.0, REPLAY_SPEED_MAX };
+    if (CaptureReplay *replay = replaySource()) {
+        replay->setSpeed(speeds[index]);
+    }
+}
+
+void MainWindow::seekReplay(void) {
+    CaptureReplay *replay = replaySource();
+    if (!replay || !replay->isOpen()) {
+        return;
+    }
+    
+    quint64 frame = replay->frameCount() * replayPosition->value() / SCALE_SLIDER_STEPS;
+    replay->seek(frame);
+    acquisition->resetClock();
+    sampleStore->clear();
+    plotManager->setFollowLive(true);
 }
 
 void MainWindow::applyDarkMode(void) {
@@ -263,64 +639,40 @@ void MainWindow::applyDarkMode(void) {
 }
 
 void MainWindow::updatePlotData(void) {
+    double origin, period;
+    bool timeBase = acquisition->sampleTimeBase(&origin, &period);
+    if (timeBase) {
+        plotManager->setTimeBase(origin, period);
+    } else {
+        plotManager->clearTimeBase();
+    }
+    updateScaleValue(scaleXSlider->value());
+    
     QVector<bool> channelVisibility;
-    for (int i = 0; i < CHANNELS; ++i) {
+    for (int i = 0; i < channelCount; ++i) {
         channelVisibility.append(channelButtons[i]->isChecked());
     }
     
-    int currentPlotLength = scaleXSlider->value();
-    plotManager->updatePlotData(plotData, xData, currentPlotLength, channelVisibility);
+    plotManager->updatePlotData(*sampleStore, visiblePoints(), channelVisibility);
+    if (spectrogramView->isVisible()) {
+        spectrogram->update(*sampleStore, channelVisibility, timeBase ? period : 0);
+    }
 }
 
 void MainWindow::updatePlot(void) {
-    if (isAcquiring && !isPaused && serialPort && serialPort->isOpen()) {
+    if (isAcquiring) {
         try {
-            QByteArray newData = serialPort->readAll();
-            if (!newData.isEmpty()) {
-                serialData.append(newData);
-                
-                if (serialData.size() > 100000) {
-                    serialData = serialData.right(50000);
-                }
-                
-                QList<QByteArray> lines = serialData.split('\n');
-                
-                if (lines.size() > 1) {
-                    int batchSize = qMin(10, lines.size() - 1);
-
-                    for (int i = 0; i < CHANNELS; ++i) {
-                        for (int j = 0; j < MAX_PLOT_POINTS - batchSize; ++j) {
-                            plotData[i][j] = plotData[i][j + batchSize];
-                        }
-                    }
-                    
-                    for (int l = 0; l < batchSize; ++l) {
-                        QByteArray line = lines[l].trimmed();
-                        if (!line.isEmpty()) {
-                            QList<QByteArray> parts = line.split('\t');
-                            if (parts.size() == CHANNELS) {
-                                for (int i = 0; i < CHANNELS; ++i) {
-                                    bool ok;
-                                    int value = parts[i].toInt(&ok);
-                                    if (ok) {
-                                        plotData[i][MAX_PLOT_POINTS - batchSize + l] = value;
-                                    }
-                                }
-                            }
-                        }
-                    }
-                    
-                    for (int i = 0; i < batchSize; ++i) {
-                        lines.removeFirst();
-                    }
-                    serialData = lines.join('\n');
-                    
-                    static QElapsedTimer plotTimer;
-                    if (!plotTimer.isValid() || plotTimer.elapsed() > 33) {
-                        plotTimer.restart();
-                        updatePlotData();
-                    }
-                }
+            int count = acquisition->poll();
+            
+            CaptureReplay *replay = replaySource();
+            if (replay && !replayPosition->isSliderDown() && replay->frameCount() > 0) {
+                replayPosition->blockSignals(true);
+                replayPosition->setValue(int(replay->currentFrame() * SCALE_SLIDER_STEPS / replay->frameCount()));
+                replayPosition->blockSignals(false);
+            }
+            
+            if (count > 0 && !isPaused) {
+                renderScheduler->requestFrame();
             }
         } catch (const std::exception& e) {
             qDebug() << "Error updating plot:" << e.what();
@@ -328,61 +680,75 @@ void MainWindow::updatePlot(void) {
     }
 }
 
-void MainWindow::setupSerial(void) {
-    serialPort = nullptr;
-    baudRate = 0;
-    timer = new QTimer(this);
-    connect(timer, &QTimer::timeout, this, &MainWindow::updatePlot);
-    timer->setInterval(33);
-    serialData.clear();
-    
-    serialScanTimer = new QTimer(this);
-    connect(serialScanTimer, &QTimer::timeout, this, &MainWindow::scanSerialPorts);
-    serialScanTimer->start(1000);
+static QString formatRate(double perSecond, const QString &unit) {
+    if (perSecond >= 1e6) {
+        return QString("%1 M%2/s").arg(perSecond / 1e6, 0, 'f', 2).arg(unit);
+    }
+    if (perSecond >= 1e3) {
+        return QString("%1 k%2/s").arg(perSecond / 1e3, 0, 'f', 1).arg(unit);
+    }
+    return QString("%1 %2/s").arg(perSecond, 0, 'f', 0).arg(unit);
 }
 
-void MainWindow::scanSerialPorts() {
-    int currentIndex = serialPorts->currentIndex();
-    QString currentPort = currentIndex > 0 ? serialPorts->itemText(currentIndex) : "";
-    
-    QStringList currentPorts;
-    for (int i = 1; i < serialPorts->count(); i++) {
-        currentPorts << serialPorts->itemText(i);
+void MainWindow::showStats(const PipelineStats &stats) {
+    statsLabel->setText(QString("%1 | %2 per channel | %3 parse errors | dropped %4 B, %5 frames | queued %6 B, %7 frames | %8/%9 fps, replot %10 ms")
+        .arg(formatRate(stats.bytesPerSecond, "B"))
+        .arg(formatRate(stats.framesPerSecond, "S"))
+        .arg(stats.parseErrors)
+        .arg(stats.droppedBytes)
+        .arg(stats.droppedFrames)
+        .arg(stats.bufferedBytes)
+        .arg(stats.queuedFrames)
+        .arg(stats.renderFps, 0, 'f', 0)
+        .arg(stats.targetFps, 0, 'f', 0)
+        .arg(stats.replotMsecs, 0, 'f', 1));
+    statsLabel->setStyleSheet(stats.saturated ? "color: #FF5252;" : "");
+
+    QStringList frameTimes;
+    for (int i = 0; i < stats.frameTimes.size(); ++i) {
+        int limit = RenderScheduler::bucketLimit(i);
+        QString bucket = limit > 0 ? QString("<= %1 ms").arg(limit) : QString("> %1 ms").arg(RenderScheduler::bucketLimit(i - 1));
+        frameTimes.append(QString("%1: %2").arg(bucket).arg(stats.frameTimes[i]));
     }
-    
-    QStringList availablePorts;
-    const auto ports = QSerialPortInfo::availablePorts();
-    for (const QSerialPortInfo &port : ports) {
-        availablePorts << port.portName();
+    statsLabel->setToolTip(QString("Frame times over the last second\n%1").arg(frameTimes.join("\n")));
+}
+
+void MainWindow::setupSerial(void) {
+    baudRate = 0;
+    renderScheduler = new RenderScheduler(this);
+    if (QGuiApplication::primaryScreen()) {
+        renderScheduler->setRefreshRate(QGuiApplication::primaryScreen()->refreshRate());
     }
+    connect(renderScheduler, &RenderScheduler::poll, this, &MainWindow::updatePlot);
+    connect(renderScheduler, &RenderScheduler::render, this, &MainWindow::updatePlotData);
     
-    if (currentPorts.size() == availablePorts.size()) {
-        bool same = true;
-        for (const QString &port : availablePorts) {
-            if (!currentPorts.contains(port)) {
-                same = false;
-                break;
+    portWatcher = new PortWatcher(this);
+    connect(portWatcher, &PortWatcher::portsChanged, this, &MainWindow::updateSerialPorts);
+    portWatcher->start();
+}
+
+void MainWindow::updateSerialPorts(const QStringList &added, const QStringList &removed) {
+    for (const QString &port : removed) {
+        int index = serialPorts->findText(port);
+        if (index > 0) {
+            if (index == serialPorts->currentIndex()) {
+                serialPorts->setCurrentIndex(0);
             }
+            serialPorts->removeItem(index);
+        }
+        const auto items = multiPorts->findItems(port, Qt::MatchExactly);
+        for (QListWidgetItem *item : items) {
+            delete item;
         }
-        if (same) return;
     }
     
-    bool wasEmpty = serialPorts->count() <= 1;
-    
-    serialPorts->clear();
-    serialPorts->addItem("Select port...");
-    for (const QString &port : availablePorts) {
+    for (const QString &port : added) {
         serialPorts->addItem(port);
+        QListWidgetItem *item = new QListWidgetItem(port, multiPorts);
+        item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+        item->setCheckState(Qt::Unchecked);
     }
-    
-    if (!currentPort.isEmpty()) {
-        int index = serialPorts->findText(currentPort);
-        if (index > 0) {
-            serialPorts->setCurrentIndex(index);
-        } else if (wasEmpty || currentIndex == 0) {
-            serialPorts->setCurrentIndex(0);
-        }
-    }
+    updateStartButton();
 }
 
 void MainWindow::setupUi(void) {
@@ -413,13 +779,13 @@ void MainWindow::setupUi(void) {
     scaleXLabel->setStyleSheet("font-weight: bold;");
     scaleLayout->addWidget(scaleXLabel);
     
-    scaleXValueLabel = new QLabel(QString("%1 points").arg(MAX_PLOT_POINTS / 4));
+    scaleXValueLabel = new QLabel(QString("%1 points").arg(sliderToPoints(pointsToSlider(MAX_PLOT_POINTS / 4))));
     scaleLayout->addWidget(scaleXValueLabel);
     
     scaleXSlider = new QSlider(Qt::Horizontal);
-    scaleXSlider->setMinimum(10);
-    scaleXSlider->setMaximum(MAX_PLOT_POINTS);
-    scaleXSlider->setValue(MAX_PLOT_POINTS / 4);
+    scaleXSlider->setMinimum(0);
+    scaleXSlider->setMaximum(SCALE_SLIDER_STEPS);
+    scaleXSlider->setValue(pointsToSlider(MAX_PLOT_POINTS / 4));
     scaleXSlider->setTickPosition(QSlider::NoTicks);
     scaleXSlider->setFixedHeight(16);
     connect(scaleXSlider, &QSlider::valueChanged, this, &MainWindow::updateScaleValue);
@@ -429,6 +795,11 @@ void MainWindow::setupUi(void) {
 
     leftLayout->addLayout(scaleLayout);
     
+    spectrogramView = new QCustomPlot();
+    spectrogramView->setMinimumHeight(240);
+    spectrogramView->setVisible(false);
+    leftLayout->addWidget(spectrogramView);
+    
     QGroupBox *controlGroup = new QGroupBox("Control Panel");
     QVBoxLayout *buttonsLayout = new QVBoxLayout(controlGroup);
     buttonsLayout->setSpacing(6);
@@ -448,42 +819,55 @@ void MainWindow::setupUi(void) {
     connect(clearButton, &QPushButton::clicked, this, &MainWindow::clearPlot);
     buttonsLayout->addWidget(clearButton);
 
-    colors = {
-        QColor(255, 82, 82),   // Modern red
-        QColor(33, 150, 243),  // Modern blue
-        QColor(76, 175, 80),   // Modern green
-        QColor(255, 193, 7)    // Modern amber
-    };
-    
+    openGlButton = new QPushButton("OpenGL");
+    openGlButton->setCheckable(true);
+    openGlButton->setToolTip("Draw the traces with OpenGL");
+    connect(openGlButton, &QPushButton::toggled, this, &MainWindow::toggleOpenGl);
+    buttonsLayout->addWidget(openGlButton);
+
+    persistenceModes = new QComboBox();
+    persistenceModes->addItem("Persistence: Off");
+    persistenceModes->addItem("Persistence: 0.2 s");
+    persistenceModes->addItem("Persistence: 1 s");
+    persistenceModes->addItem("Persistence: 4 s");
+    persistenceModes->addItem("Persistence: Infinite");
+    persistenceModes->setToolTip("Show how often the signal passes through each pixel, one sweep of the visible length per trigger");
+    connect(persistenceModes, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::selectPersistence);
+    buttonsLayout->addWidget(persistenceModes);
+
+    spectrogramButton = new QPushButton("Spectrogram");
+    spectrogramButton->setCheckable(true);
+    spectrogramButton->setToolTip("Show how each visible channel's spectrum changes over time, below the plot");
+    connect(spectrogramButton, &QPushButton::toggled, this, &MainWindow::toggleSpectrogram);
+    buttonsLayout->addWidget(spectrogramButton);
+
+    recordButton = new QPushButton("Record");
+    recordButton->setCheckable(true);
+    recordButton->setEnabled(false);
+    connect(recordButton, &QPushButton::toggled, this, &MainWindow::toggleRecording);
+    buttonsLayout->addWidget(recordButton);
+
+    shareButton = new QPushButton("Share Live Data");
+    shareButton->setCheckable(true);
+    connect(shareButton, &QPushButton::toggled, this, &MainWindow::toggleSharing);
+    buttonsLayout->addWidget(shareButton);
+
+#ifdef Q_OS_UNIX
+    sharedMemoryButton = new QPushButton("Share Memory");
+    sharedMemoryButton->setCheckable(true);
+    connect(sharedMemoryButton, &QPushButton::toggled, this, &MainWindow::toggleSharedMemory);
+    buttonsLayout->addWidget(sharedMemoryButton);
+#endif
+
     QGroupBox *channelsGroup = new QGroupBox("Channels");
     QVBoxLayout *channelsLayout = new QVBoxLayout(channelsGroup);
     channelsLayout->setSpacing(6);
     channelsLayout->setContentsMargins(6, 12, 6, 6);
     
-    QGridLayout *channelsGridLayout = new QGridLayout();
+    channelsGridLayout = new QGridLayout();
     channelsGridLayout->setSpacing(6);
     channelsLayout->addLayout(channelsGridLayout);
     
-    for (int i = 0; i < CHANNELS; ++i) {
-        QPushButton *button = new QPushButton(QString("Channel %1").arg(i + 1));
-        button->setCheckable(true);
-        
-        if (i == 0) {
-            button->setStyleSheet(QString("background-color: %1; color: white;").arg(colors[i].name()));
-            button->setChecked(true);
-        } else {
-            button->setStyleSheet("background-color: rgb(45, 45, 45); color: white;");
-            button->setChecked(false);
-        }
-        
-        connect(button, &QPushButton::toggled, [=](bool checked) { toggleChannel(i, checked); });
-        channelButtons.append(button);
-        
-        int row = i / 2;
-        int col = i % 2;
-        channelsGridLayout->addWidget(button, row, col);
-    }
-    
     rightLayout->addWidget(channelsGroup, 1);
 
     QGroupBox *connectionGroup = new QGroupBox("Connection Settings");
@@ -492,33 +876,80 @@ void MainWindow::setupUi(void) {
     gridLayout->setContentsMargins(6, 12, 6, 6);
     rightLayout->addWidget(connectionGroup, 1);
 
+    QLabel *sourceLabel = new QLabel("Source:");
+    sourceLabel->setStyleSheet("font-weight: bold; background-color: transparent;");
+    gridLayout->addWidget(sourceLabel, 0, 0);
+    
+    sourceTypes = new QComboBox();
+    sourceTypes->setStyleSheet("padding-left: 8px;");
+    sourceTypes->addItem("Serial port");
+    sourceTypes->addItem("Multiple serial ports");
+    sourceTypes->addItem("Synthetic");
+#ifdef Q_OS_UNIX
+    sourceTypes->addItem("Pseudo-terminal");
+#endif
+    gridLayout->addWidget(sourceTypes, 0, 1);
+
     QLabel *baudLabel = new QLabel("Baud Rate:");
     baudLabel->setStyleSheet("font-weight: bold; background-color: transparent;");
-    gridLayout->addWidget(baudLabel, 0, 0);
+    gridLayout->addWidget(baudLabel, 1, 0);
     
     baudRates = new QComboBox();
     baudRates->setStyleSheet("padding-left: 8px;");
     baudRates->addItem("Select baud rate...");
+    baudRates->addItem("Auto detect");
     QVector<int> baudRateOptions = {9600, 19200, 38400, 57600, 115200, 230400, 460800, 921600};
     for (int baud : baudRateOptions) {
         baudRates->addItem(QString::number(baud));
     }
-    gridLayout->addWidget(baudRates, 0, 1);
+    gridLayout->addWidget(baudRates, 1, 1);
     connect(baudRates, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::selectBaudRate);
 
     QLabel *portLabel = new QLabel("Serial Port:");
     portLabel->setStyleSheet("font-weight: bold; background-color: transparent;");
-    gridLayout->addWidget(portLabel, 1, 0);
+    gridLayout->addWidget(portLabel, 2, 0);
     
     serialPorts = new QComboBox();
     serialPorts->setStyleSheet("padding-left: 8px;");
     serialPorts->addItem("Select port...");
-    const auto ports = QSerialPortInfo::availablePorts();
-    for (const QSerialPortInfo &port : ports) {
-        serialPorts->addItem(port.portName());
-    }
-    gridLayout->addWidget(serialPorts, 1, 1);
+    gridLayout->addWidget(serialPorts, 2, 1);
+    
+    multiPorts = new QListWidget();
+    multiPorts->setVisible(false);
+    multiPorts->setToolTip(QString("Check 2 to %1 ports of %2 channels each").arg(MULTI_MAX_PORTS).arg(CHANNELS));
+    gridLayout->addWidget(multiPorts, 2, 1);
+    connect(multiPorts, &QListWidget::itemChanged, this, &MainWindow::updateStartButton);
     connect(serialPorts, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::selectSerialPort);
+    connect(sourceTypes, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::selectSourceType);
+
+    QGroupBox *replayGroup = new QGroupBox("Replay");
+    QGridLayout *replayLayout = new QGridLayout(replayGroup);
+    replayLayout->setSpacing(6);
+    replayLayout->setContentsMargins(6, 12, 6, 6);
+    rightLayout->addWidget(replayGroup, 1);
+    
+    openCaptureButton = new QPushButton("Open Capture...");
+    connect(openCaptureButton, &QPushButton::clicked, this, &MainWindow::openCapture);
+    replayLayout->addWidget(openCaptureButton, 0, 0, 1, 2);
+    
+    QLabel *speedLabel = new QLabel("Speed:");
+    speedLabel->setStyleSheet("font-weight: bold; background-color: transparent;");
+    replayLayout->addWidget(speedLabel, 1, 0);
+    
+    replaySpeeds = new QComboBox();
+    replaySpeeds->setStyleSheet("padding-left: 8px;");
+    replaySpeeds->addItems({"1x", "10x", "100x", "Max"});
+    replaySpeeds->setEnabled(false);
+    replayLayout->addWidget(replaySpeeds, 1, 1);
+    connect(replaySpeeds, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::selectReplaySpeed);
+    
+    replayPosition = new QSlider(Qt::Horizontal);
+    replayPosition->setMinimum(0);
+    replayPosition->setMaximum(SCALE_SLIDER_STEPS);
+    replayPosition->setFixedHeight(16);
+    replayPosition->setEnabled(false);
+    connect(replayPosition, &QSlider::sliderReleased, this, &MainWindow::seekReplay);
+    replayLayout->addWidget(replayPosition, 2, 0, 1, 2);
 
     QGroupBox *actionGroup = new QGroupBox("Actions");
     QHBoxLayout *actionLayout = new QHBoxLayout(actionGroup);
@@ -544,6 +975,9 @@ void MainWindow::setupUi(void) {
     QStatusBar *statusBar = new QStatusBar(this);
     setStatusBar(statusBar);
     statusBar->showMessage("Ready");
+    
+    statsLabel = new QLabel();
+    statusBar->addPermanentWidget(statsLabel);
 
     applyDarkMode();
 }
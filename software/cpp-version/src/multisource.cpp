@@ -0,0 +1,217 @@
+#include <QStringList>
+#include <cstring>
+
+#include "multisource.h"
+
+#define MULTI_SOURCE_COMPACT_FRAMES 4096
+
+MultiSource::MultiSource(QObject *parent) : DataSource(parent), opened(false) {
+}
+
+MultiSource::~MultiSource(void) {
+    close();
+    for (Device &device : devices) {
+        delete device.source;
+    }
+}
+
+void MultiSource::addSource(DataSource *source) {
+    Q_ASSERT(!opened);
+    source->setParent(nullptr);
+
+    Device device;
+    device.source = source;
+    device.reader = nullptr;
+    device.channels = source->channelCount();
+    device.stagedHead = 0;
+    device.stagedFirst = 0;
+    device.received = 0;
+    device.lastArrival = 0;
+    devices.append(device);
+}
+
+QString MultiSource::name(void) const {
+    QStringList names;
+    for (const Device &device : devices) {
+        names << device.source->name();
+    }
+    return names.join(", ");
+}
+
+bool MultiSource::open(QString *error) {
+    close();
+    if (devices.isEmpty()) {
+        if (error) {
+            *error = "No devices selected";
+        }
+        return false;
+    }
+
+    epoch.start();
+    for (Device &device : devices) {
+        device.clock.reset();
+        device.staged.clear();
+        device.stagedHead = 0;
+        device.stagedFirst = 0;
+        device.received = 0;
+        device.lastArrival = 0;
+
+        device.reader = new SourceReader(device.source, &epoch, this);
+        QString readerError;
+        if (!device.reader->open(&readerError)) {
+            if (error) {
+                *error = QString("%1: %2").arg(device.source->name(), readerError);
+            }
+            close();
+            return false;
+        }
+        device.channels = device.source->channelCount();
+    }
+
+    opened = true;
+    return true;
+}
+
+void MultiSource::close(void) {
+    for (Device &device : devices) {
+        if (device.reader) {
+            device.reader->close();
+            delete device.reader;
+            device.reader = nullptr;
+        }
+    }
+    opened = false;
+}
+
+int MultiSource::channelCount(void) const {
+    int channels = 0;
+    for (const Device &device : devices) {
+        channels += device.channels;
+    }
+    return channels;
+}
+
+ChannelScale MultiSource::scale(int channel) const {
+    for (const Device &device : devices) {
+        if (channel < device.channels) {
+            return device.source->scale(channel);
+        }
+        channel -= device.channels;
+    }
+    return ChannelScale();
+}
+
+SourceStats MultiSource::stats(void) const {
+    SourceStats total;
+    for (const Device &device : devices) {
+        SourceStats stats = device.source->stats();
+        total.bytes += stats.bytes;
+        total.parseErrors += stats.parseErrors;
+        total.droppedBytes += stats.droppedBytes;
+        total.bufferedBytes += stats.bufferedBytes;
+        total.droppedFrames += stats.droppedFrames;
+        total.queuedFrames += device.received - device.stagedFirst;
+        if (device.reader) {
+            total.droppedFrames += device.reader->droppedFrames();
+            total.queuedFrames += device.reader->queuedFrameCount();
+        }
+    }
+    return total;
+}
+
+void MultiSource::drain(Device &device) {
+    while (device.reader->takeBlock(device.block)) {
+        const FrameBlock &block = device.block;
+        int size = device.staged.size();
+        device.staged.resize(size + block.count * device.channels);
+        memcpy(device.staged.data() + size, block.frames.constData(), block.count * device.channels * sizeof(int16_t));
+        device.received += block.count;
+        device.lastArrival = block.timestamps[block.count - 1];
+        device.clock.addObservation(device.received - 1, device.lastArrival);
+    }
+
+    if (device.received - device.stagedFirst > READER_QUEUE_FRAMES) {
+        discardBefore(device, device.received - READER_QUEUE_FRAMES);
+    }
+}
+
+const int16_t *MultiSource::stagedFrame(const Device &device, qint64 frame) const {
+    if (frame < device.stagedFirst || frame >= device.received) {
+        return nullptr;
+    }
+    return device.staged.constData() + (device.stagedHead + frame - device.stagedFirst) * device.channels;
+}
+
+void MultiSource::discardBefore(Device &device, qint64 frame) {
+    qint64 count = qMin(frame, device.received) - device.stagedFirst;
+    if (count <= 0) {
+        return;
+    }
+    device.stagedHead += count;
+    device.stagedFirst += count;
+
+    if (device.stagedHead >= MULTI_SOURCE_COMPACT_FRAMES && device.stagedHead * 2 * device.channels >= device.staged.size()) {
+        device.staged.remove(0, device.stagedHead * device.channels);
+        device.stagedHead = 0;
+    }
+}
+
+int MultiSource::readFrames(int16_t *frames, qint64 *timestamps, int maxFrames) {
+    if (!opened) {
+        return 0;
+    }
+
+    for (Device &device : devices) {
+        drain(device);
+    }
+
+    qint64 now = epoch.nsecsElapsed();
+    int channels = channelCount();
+    Device &reference = devices[0];
+    picks.resize(devices.size());
+    int count = 0;
+
+    while (count < maxFrames && reference.stagedFirst < reference.received && reference.clock.isValid()) {
+        qint64 referenceFrame = reference.stagedFirst;
+        double t = reference.clock.timeOf(referenceFrame);
+
+        bool ready = true;
+        for (int d = 1; d < devices.size(); ++d) {
+            const Device &device = devices[d];
+            bool valid = device.clock.isValid();
+            qint64 pick = valid ? qRound64(device.clock.frameAt(t)) : -1;
+            if (!valid || pick >= device.received) {
+                if (now - device.lastArrival < MULTI_SOURCE_STALL_NS) {
+                    ready = false;
+                    break;
+                }
+                pick = device.received - 1;
+            }
+            picks[d] = qMax(pick, device.stagedFirst);
+        }
+        if (!ready) {
+            break;
+        }
+
+        int16_t *out = frames + count * channels;
+        memcpy(out, stagedFrame(reference, referenceFrame), reference.channels * sizeof(int16_t));
+        out += reference.channels;
+        for (int d = 1; d < devices.size(); ++d) {
+            Device &device = devices[d];
+            const int16_t *frame = stagedFrame(device, picks[d]);
+            if (frame) {
+                memcpy(out, frame, device.channels * sizeof(int16_t));
+            } else {
+                memset(out, 0, device.channels * sizeof(int16_t));
+            }
+            out += device.channels;
+            discardBefore(device, picks[d]);
+        }
+
+        timestamps[count] = qint64(t);
+        discardBefore(reference, referenceFrame + 1);
+        ++count;
+    }
+
+    return count;
+}
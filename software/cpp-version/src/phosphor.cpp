@@ -0,0 +1,533 @@
+#include <QMutexLocker>
+#include <QElapsedTimer>
+#include <QtMath>
+#include <algorithm>
+
+#include "phosphor.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PHOSPHOR_X86 1
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#define PHOSPHOR_NEON 1
+#include <arm_neon.h>
+#endif
+
+typedef void (*RowKernel)(const int16_t *raw, int count, int32_t mul, int32_t add, int shift, int32_t *rows);
+typedef void (*DecayKernel)(quint16 *hits, qint64 count, int shift);
+
+static void rowsScalar(const int16_t *raw, int count, int32_t mul, int32_t add, int shift, int32_t *rows) {
+    for (int i = 0; i < count; ++i) {
+        rows[i] = (raw[i] * mul + add) >> shift;
+    }
+}
+
+static void decayScalar(quint16 *hits, qint64 count, int shift) {
+    for (qint64 i = 0; i < count; ++i) {
+        quint16 loss = (hits[i] >> shift) + 1;
+        hits[i] = hits[i] > loss ? hits[i] - loss : 0;
+    }
+}
+
+#ifdef PHOSPHOR_X86
+// SSE2 has no 32-bit multiply, but madd of (raw, 0) pairs by (mul, 0) pairs
+// gives raw * mul in each 32-bit lane.
+__attribute__((target("sse2")))
+static void rowsSse2(const int16_t *raw, int count, int32_t mul, int32_t add, int shift, int32_t *rows) {
+    int i = 0;
+    __m128i zero = _mm_setzero_si128();
+    __m128i factor = _mm_set1_epi32(mul & 0xFFFF);
+    __m128i offset = _mm_set1_epi32(add);
+    __m128i bits = _mm_cvtsi32_si128(shift);
+    for (; i + 8 <= count; i += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(raw + i));
+        __m128i low = _mm_madd_epi16(_mm_unpacklo_epi16(v, zero), factor);
+        __m128i high = _mm_madd_epi16(_mm_unpackhi_epi16(v, zero), factor);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(rows + i), _mm_sra_epi32(_mm_add_epi32(low, offset), bits));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(rows + i + 4), _mm_sra_epi32(_mm_add_epi32(high, offset), bits));
+    }
+    rowsScalar(raw + i, count - i, mul, add, shift, rows + i);
+}
+
+__attribute__((target("sse2")))
+static void decaySse2(quint16 *hits, qint64 count, int shift) {
+    qint64 i = 0;
+    __m128i one = _mm_set1_epi16(1);
+    __m128i bits = _mm_cvtsi32_si128(shift);
+    for (; i + 8 <= count; i += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hits + i));
+        __m128i loss = _mm_add_epi16(_mm_srl_epi16(v, bits), one);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(hits + i), _mm_subs_epu16(v, loss));
+    }
+    decayScalar(hits + i, count - i, shift);
+}
+
+__attribute__((target("avx2")))
+static void rowsAvx2(const int16_t *raw, int count, int32_t mul, int32_t add, int shift, int32_t *rows) {
+    int i = 0;
+    __m256i factor = _mm256_set1_epi32(mul);
+    __m256i offset = _mm256_set1_epi32(add);
+    __m128i bits = _mm_cvtsi32_si128(shift);
+    for (; i + 8 <= count; i += 8) {
+        __m256i v = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(raw + i)));
+        __m256i row = _mm256_sra_epi32(_mm256_add_epi32(_mm256_mullo_epi32(v, factor), offset), bits);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(rows + i), row);
+    }
+    rowsScalar(raw + i, count - i, mul, add, shift, rows + i);
+}
+
+__attribute__((target("avx2")))
+static void decayAvx2(quint16 *hits, qint64 count, int shift) {
+    qint64 i = 0;
+    __m256i one = _mm256_set1_epi16(1);
+    __m128i bits = _mm_cvtsi32_si128(shift);
+    for (; i + 16 <= count; i += 16) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hits + i));
+        __m256i loss = _mm256_add_epi16(_mm256_srl_epi16(v, bits), one);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(hits + i), _mm256_subs_epu16(v, loss));
+    }
+    decaySse2(hits + i, count - i, shift);
+}
+#endif
+
+#ifdef PHOSPHOR_NEON
+static void rowsNeon(const int16_t *raw, int count, int32_t mul, int32_t add, int shift, int32_t *rows) {
+    int i = 0;
+    int32x4_t offset = vdupq_n_s32(add);
+    int32x4_t bits = vdupq_n_s32(-shift);
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t v = vld1q_s16(raw + i);
+        int32x4_t low = vmlaq_n_s32(offset, vmovl_s16(vget_low_s16(v)), mul);
+        int32x4_t high = vmlaq_n_s32(offset, vmovl_s16(vget_high_s16(v)), mul);
+        vst1q_s32(rows + i, vshlq_s32(low, bits));
+        vst1q_s32(rows + i + 4, vshlq_s32(high, bits));
+    }
+    rowsScalar(raw + i, count - i, mul, add, shift, rows + i);
+}
+
+static void decayNeon(quint16 *hits, qint64 count, int shift) {
+    qint64 i = 0;
+    uint16x8_t one = vdupq_n_u16(1);
+    int16x8_t bits = vdupq_n_s16(-shift);
+    for (; i + 8 <= count; i += 8) {
+        uint16x8_t v = vld1q_u16(hits + i);
+        vst1q_u16(hits + i, vqsubq_u16(v, vaddq_u16(vshlq_u16(v, bits), one)));
+    }
+    decayScalar(hits + i, count - i, shift);
+}
+#endif
+
+struct KernelChoice {
+    RowKernel rows;
+    DecayKernel decay;
+    const char *name;
+};
+
+static KernelChoice chooseKernel(void) {
+#if defined(PHOSPHOR_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return {rowsAvx2, decayAvx2, "avx2"};
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return {rowsSse2, decaySse2, "sse2"};
+    }
+#elif defined(PHOSPHOR_NEON)
+    return {rowsNeon, decayNeon, "neon"};
+#endif
+    return {rowsScalar, decayScalar, "scalar"};
+}
+
+static const KernelChoice &kernelChoice(void) {
+    static const KernelChoice choice = chooseKernel();
+    return choice;
+}
+
+Phosphor::Phosphor(QObject *parent) : QThread(parent), channels(0), opened(false), current(nullptr), stopping(false), changes(0), columnStep(0), position(-1), waited(0), triggerChannel(0), triggerLevel(0), triggerRaw(0), triggerRising(true), previousTriggerSample(0), havePrevious(false), decayShift(0), sweepCount(0), lostFrames(0) {
+}
+
+Phosphor::~Phosphor(void) {
+    close();
+}
+
+const char *Phosphor::kernelName(void) {
+    return kernelChoice().name;
+}
+
+void Phosphor::open(int channels) {
+    close();
+
+    this->channels = channels;
+    for (int i = 0; i < PHOSPHOR_POOL_BLOCKS; ++i) {
+        Block *block = new Block;
+        block->frames = 0;
+        block->samples.resize(PHOSPHOR_BLOCK_FRAMES * channels);
+        pool.append(block);
+    }
+    freeBlocks = pool;
+    pending.clear();
+    current = nullptr;
+    rows.resize(PHOSPHOR_BLOCK_FRAMES);
+    stopping = false;
+    sweepCount.storeRelease(0);
+    lostFrames.storeRelease(0);
+
+    // The worker starts from empty counts and picks up everything set so far,
+    // the geometry set while closed included.
+    geometry = PhosphorGeometry();
+    changes = GeometryChanged | ScalesChanged | TriggerChanged | DecayChanged;
+
+    opened = true;
+    start();
+}
+
+void Phosphor::close(void) {
+    if (!opened) {
+        return;
+    }
+
+    {
+        QMutexLocker locker(&mutex);
+        stopping = true;
+        blockReady.wakeAll();
+    }
+    wait();
+
+    qDeleteAll(pool);
+    pool.clear();
+    freeBlocks.clear();
+    pending.clear();
+    current = nullptr;
+    hits = QVector<quint16>();
+    back = QVector<quint16>();
+    {
+        QMutexLocker locker(&frontMutex);
+        front = QVector<quint16>();
+        frontGeometry = PhosphorGeometry();
+    }
+    opened = false;
+}
+
+void Phosphor::setScales(const QVector<ChannelScale> &newScales) {
+    QMutexLocker locker(&mutex);
+    requested.scales = newScales;
+    requestChange(ScalesChanged);
+}
+
+void Phosphor::setGeometry(const PhosphorGeometry &newGeometry) {
+    QMutexLocker locker(&mutex);
+    if (newGeometry != requested.geometry) {
+        requested.geometry = newGeometry;
+        requestChange(GeometryChanged);
+    }
+}
+
+void Phosphor::setTrigger(int channel, double level) {
+    QMutexLocker locker(&mutex);
+    if (channel != requested.triggerChannel || level != requested.triggerLevel) {
+        requested.triggerChannel = channel;
+        requested.triggerLevel = level;
+        requestChange(TriggerChanged);
+    }
+}
+
+void Phosphor::setDecay(int shift) {
+    QMutexLocker locker(&mutex);
+    requested.decayShift = qBound(0, shift, 15);
+    requestChange(DecayChanged);
+}
+
+void Phosphor::clear(void) {
+    QMutexLocker locker(&mutex);
+    requestChange(CountsCleared);
+}
+
+// Called with the mutex held; the worker applies the change before its next
+// block.
+void Phosphor::requestChange(int change) {
+    changes |= change;
+    blockReady.wakeOne();
+}
+
+void Phosphor::applySettings(const Settings &settings, int changed) {
+    bool remap = false;
+    if (changed & ScalesChanged) {
+        scales = settings.scales;
+        hits.fill(0);
+        remap = true;
+    }
+
+    int cells = settings.geometry.isValid() ? channels * settings.geometry.columns * settings.geometry.rows : 0;
+    if ((changed & GeometryChanged) && (settings.geometry != geometry || hits.size() != cells)) {
+        geometry = settings.geometry;
+        if (geometry.isValid()) {
+            hits.fill(0, cells);
+            columnStep = (quint64(geometry.columns) << 32) / quint64(geometry.sweepLength);
+        } else {
+            hits.clear();
+        }
+        position = -1;
+        waited = 0;
+        remap = true;
+    }
+
+    if ((changed & TriggerChanged) && (settings.triggerChannel != triggerChannel || settings.triggerLevel != triggerLevel)) {
+        triggerChannel = settings.triggerChannel;
+        triggerLevel = settings.triggerLevel;
+        havePrevious = false;
+        remap = true;
+    }
+
+    if (changed & DecayChanged) {
+        decayShift = settings.decayShift;
+    }
+
+    if (changed & CountsCleared) {
+        hits.fill(0);
+        position = -1;
+        waited = 0;
+        havePrevious = false;
+    }
+
+    if (remap) {
+        updateMappings();
+    }
+}
+
+// Picks the largest fixed-point shift whose factor still fits the kernels'
+// 16-bit multiplier; a range narrower than that resolves nothing. The
+// trigger level is turned into raw counts the same way, a negative gain
+// making a rising value a falling count.
+void Phosphor::updateMappings(void) {
+    mappings.resize(channels);
+    double span = geometry.upper - geometry.lower;
+    for (int c = 0; c < channels; ++c) {
+        ChannelScale scale = c < scales.size() ? scales[c] : ChannelScale();
+        RowMapping mapping = { 0, -1, 0 };
+        if (geometry.isValid()) {
+            double factor = scale.gain * geometry.rows / span;
+            double offset = (scale.offset - geometry.lower) * geometry.rows / span;
+            for (int shift = 16; shift >= 0; --shift) {
+                double mul = qRound(factor * (1 << shift));
+                double add = std::floor(offset * (1 << shift));
+                if (qAbs(mul) <= 32767 && qAbs(add) <= (1 << 30)) {
+                    mapping = { int32_t(mul), int32_t(add), shift };
+                    break;
+                }
+            }
+        }
+        mappings[c] = mapping;
+    }
+
+    triggerRaw = 0;
+    triggerRising = true;
+    if (triggerChannel >= 0 && triggerChannel < channels) {
+        ChannelScale scale = triggerChannel < scales.size() ? scales[triggerChannel] : ChannelScale();
+        double raw = scale.gain != 0 ? qBound(-65536.0, (triggerLevel - scale.offset) / scale.gain, 65536.0) : 0;
+        triggerRising = scale.gain >= 0;
+        triggerRaw = int32_t(triggerRising ? std::ceil(raw) : std::floor(raw));
+    }
+}
+
+void Phosphor::publish(const int16_t *frames, int count, int sourceChannels) {
+    if (!opened) {
+        return;
+    }
+
+    for (int n = 0; n < count;) {
+        if (!current) {
+            QMutexLocker locker(&mutex);
+            if (freeBlocks.isEmpty()) {
+                lostFrames.fetchAndAddRelaxed(count - n);
+                return;
+            }
+            current = freeBlocks.takeLast();
+            current->frames = 0;
+        }
+
+        int take = qMin(count - n, PHOSPHOR_BLOCK_FRAMES - current->frames);
+        for (int c = 0; c < channels; ++c) {
+            int16_t *out = current->samples.data() + c * PHOSPHOR_BLOCK_FRAMES + current->frames;
+            if (c < sourceChannels) {
+                const int16_t *in = frames + n * sourceChannels + c;
+                for (int i = 0; i < take; ++i) {
+                    out[i] = in[i * sourceChannels];
+                }
+            } else {
+                std::fill(out, out + take, int16_t(0));
+            }
+        }
+        current->frames += take;
+        n += take;
+        if (current->frames == PHOSPHOR_BLOCK_FRAMES) {
+            submitCurrent();
+        }
+    }
+
+    // A slow source would otherwise keep a block to itself for seconds.
+    if (current && current->frames > 0) {
+        submitCurrent();
+    }
+}
+
+void Phosphor::submitCurrent(void) {
+    QMutexLocker locker(&mutex);
+    pending.enqueue(current);
+    current = nullptr;
+    blockReady.wakeOne();
+}
+
+bool Phosphor::snapshot(QVector<quint16> *out, PhosphorGeometry *size, int *count) const {
+    QMutexLocker locker(&frontMutex);
+    if (!frontGeometry.isValid() || front.isEmpty()) {
+        return false;
+    }
+    out->resize(front.size());
+    std::copy(front.constBegin(), front.constEnd(), out->begin());
+    *size = frontGeometry;
+    *count = channels;
+    return true;
+}
+
+// The copy is made without any lock; only the swap is done under frontMutex.
+void Phosphor::publishCounts(void) {
+    back.resize(hits.size());
+    std::copy(hits.constBegin(), hits.constEnd(), back.begin());
+    QMutexLocker locker(&frontMutex);
+    front.swap(back);
+    frontGeometry = geometry;
+}
+
+// One block or one batch of setting changes per pass, taken under the mutex
+// and worked on without it.
+void Phosphor::run(void) {
+    QElapsedTimer clock;
+    clock.start();
+    qint64 decayed = 0;
+    qint64 published = -PHOSPHOR_PUBLISH_MSECS;
+    bool changed = true;
+
+    QMutexLocker locker(&mutex);
+    while (!stopping) {
+        if (pending.isEmpty() && !changes) {
+            blockReady.wait(&mutex, PHOSPHOR_DECAY_MSECS);
+        }
+        Settings settings;
+        int taken = changes;
+        Block *block = nullptr;
+        if (taken) {
+            settings = requested;
+            changes = 0;
+        } else if (!pending.isEmpty()) {
+            block = pending.dequeue();
+        }
+        locker.unlock();
+
+        if (taken) {
+            applySettings(settings, taken);
+            changed = true;
+        }
+        if (block) {
+            accumulate(block);
+            changed = true;
+        }
+
+        qint64 now = clock.elapsed();
+        qint64 steps = (now - decayed) / PHOSPHOR_DECAY_MSECS;
+        if (steps > 0) {
+            decayed += steps * PHOSPHOR_DECAY_MSECS;
+            if (decayShift > 0) {
+                decay(int(qMin<qint64>(steps, PHOSPHOR_MAX_DECAY_STEPS)));
+                changed = true;
+            }
+        }
+        if (changed && now - published >= PHOSPHOR_PUBLISH_MSECS) {
+            publishCounts();
+            published = now;
+            changed = false;
+        }
+
+        locker.relock();
+        if (block) {
+            freeBlocks.append(block);
+        }
+    }
+}
+
+void Phosphor::accumulate(const Block *block) {
+    if (!geometry.isValid() || hits.isEmpty()) {
+        return;
+    }
+
+    for (int from = 0; from < block->frames;) {
+        if (position < 0) {
+            from = findTrigger(block, from);
+            if (from >= block->frames) {
+                break;
+            }
+            position = 0;
+            sweepCount.fetchAndAddRelaxed(1);
+        }
+
+        int count = int(qMin<qint64>(block->frames - from, geometry.sweepLength - position));
+        for (int c = 0; c < channels; ++c) {
+            accumulateRun(c, block->samples.constData() + c * PHOSPHOR_BLOCK_FRAMES + from, count);
+        }
+        position += count;
+        from += count;
+        if (position >= geometry.sweepLength) {
+            position = -1;
+            waited = 0;
+        }
+    }
+
+    if (triggerChannel >= 0 && triggerChannel < channels && block->frames > 0) {
+        previousTriggerSample = block->samples[triggerChannel * PHOSPHOR_BLOCK_FRAMES + block->frames - 1];
+        havePrevious = true;
+    }
+}
+
+// The frame that starts the next sweep, or block->frames if this block has
+// none. Without a trigger channel every sweep follows the previous one.
+int Phosphor::findTrigger(const Block *block, int from) {
+    if (triggerChannel < 0 || triggerChannel >= channels) {
+        return from;
+    }
+
+    const int16_t *raw = block->samples.constData() + triggerChannel * PHOSPHOR_BLOCK_FRAMES;
+    bool known = from > 0 || havePrevious;
+    int32_t previous = from > 0 ? raw[from - 1] : previousTriggerSample;
+    for (int i = from; i < block->frames; ++i) {
+        int32_t sample = raw[i];
+        bool crossed = triggerRising ? previous < triggerRaw && sample >= triggerRaw : previous > triggerRaw && sample <= triggerRaw;
+        if ((known && crossed) || ++waited >= geometry.sweepLength) {
+            return i;
+        }
+        previous = sample;
+        known = true;
+    }
+    return block->frames;
+}
+
+// Rows come out of the SIMD kernel; the counts are then bumped one sample at a
+// time since the cells a run lands in are scattered.
+void Phosphor::accumulateRun(int channel, const int16_t *raw, int count) {
+    const RowMapping &mapping = mappings[channel];
+    int32_t *row = rows.data();
+    kernelChoice().rows(raw, count, mapping.mul, mapping.add, mapping.shift, row);
+
+    unsigned rowCount = geometry.rows;
+    quint16 *cells = hits.data() + qint64(channel) * geometry.columns * geometry.rows;
+    for (int i = 0; i < count; ++i) {
+        if (unsigned(row[i]) < rowCount) {
+            quint16 &cell = cells[((quint64(position + i) * columnStep) >> 32) * rowCount + row[i]];
+            cell += cell != 0xFFFF;
+        }
+    }
+}
+
+void Phosphor::decay(int steps) {
+    for (int i = 0; i < steps; ++i) {
+        kernelChoice().decay(hits.data(), hits.size(), decayShift);
+    }
+}
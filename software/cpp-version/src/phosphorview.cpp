@@ -0,0 +1,113 @@
+#include <QtMath>
+
+#include "phosphorview.h"
+
+// Sits on the traces' layer, which the persistence view replaces.
+PhosphorView::PhosphorView(QCustomPlot *plot) : QCPLayerable(plot), phosphor(nullptr) {
+    setVisible(false);
+}
+
+void PhosphorView::setPhosphor(Phosphor *newPhosphor) {
+    phosphor = newPhosphor;
+    setVisible(phosphor != nullptr);
+}
+
+void PhosphorView::setChannels(const QVector<QColor> &newColors, const QVector<bool> &newVisible) {
+    visible = newVisible;
+    if (newColors != colors) {
+        colors = newColors;
+        buildPalettes();
+    }
+}
+
+void PhosphorView::applyDefaultAntialiasingHint(QCPPainter *painter) const {
+    applyAntialiasingHint(painter, false, QCP::aePlottables);
+}
+
+QRect PhosphorView::clipRect(void) const {
+    return mParentPlot->axisRect()->rect();
+}
+
+// Faint cells are also less opaque, so the grid shows through the afterglow.
+void PhosphorView::buildPalettes(void) {
+    palettes.resize(colors.size());
+    for (int c = 0; c < colors.size(); ++c) {
+        QCPColorGradient gradient;
+        gradient.clearColorStops();
+        gradient.setColorInterpolation(QCPColorGradient::ciRGB);
+        gradient.setLevelCount(PHOSPHOR_VIEW_LEVELS);
+        gradient.setColorStopAt(0, colors[c].darker(300));
+        gradient.setColorStopAt(0.7, colors[c]);
+        gradient.setColorStopAt(1, Qt::white);
+
+        QVector<QRgb> &palette = palettes[c];
+        palette.resize(PHOSPHOR_VIEW_LEVELS);
+        palette[0] = 0;
+        for (int i = 1; i < PHOSPHOR_VIEW_LEVELS; ++i) {
+            QRgb rgb = gradient.color(i, QCPRange(0, PHOSPHOR_VIEW_LEVELS - 1));
+            int alpha = 96 + (255 - 96) * i / (PHOSPHOR_VIEW_LEVELS - 1);
+            palette[i] = qPremultiply(qRgba(qRed(rgb), qGreen(rgb), qBlue(rgb), alpha));
+        }
+    }
+}
+
+static inline QRgb addLight(QRgb a, QRgb b) {
+    return qRgba(qMin(255, qRed(a) + qRed(b)), qMin(255, qGreen(a) + qGreen(b)), qMin(255, qBlue(a) + qBlue(b)), qMin(255, qAlpha(a) + qAlpha(b)));
+}
+
+void PhosphorView::draw(QCPPainter *painter) {
+    PhosphorGeometry geometry;
+    int channels;
+    if (!phosphor || !phosphor->snapshot(&hits, &geometry, &channels)) {
+        return;
+    }
+
+    int cellCount = geometry.columns * geometry.rows;
+    quint16 busiest = 0;
+    for (int c = 0; c < channels && c < visible.size() && c < palettes.size(); ++c) {
+        if (visible[c]) {
+            const quint16 *cells = hits.constData() + c * cellCount;
+            for (int i = 0; i < cellCount; ++i) {
+                busiest = qMax(busiest, cells[i]);
+            }
+        }
+    }
+    if (busiest == 0) {
+        return;
+    }
+
+    levels.resize(busiest + 1);
+    levels[0] = 0;
+    double scale = (PHOSPHOR_VIEW_LEVELS - 1) / std::log1p(double(busiest));
+    for (int h = 1; h <= busiest; ++h) {
+        levels[h] = uchar(qMax(1, qRound(std::log1p(double(h)) * scale)));
+    }
+
+    if (image.size() != QSize(geometry.columns, geometry.rows)) {
+        image = QImage(geometry.columns, geometry.rows, QImage::Format_ARGB32_Premultiplied);
+    }
+    image.fill(Qt::transparent);
+    QRgb *pixels = reinterpret_cast<QRgb*>(image.bits());
+    int stride = image.bytesPerLine() / sizeof(QRgb);
+
+    // Row 0 is the bottom of the image.
+    for (int c = 0; c < channels && c < visible.size() && c < palettes.size(); ++c) {
+        if (!visible[c]) {
+            continue;
+        }
+        const QRgb *palette = palettes[c].constData();
+        const quint16 *cells = hits.constData() + c * cellCount;
+        for (int column = 0; column < geometry.columns; ++column) {
+            const quint16 *cell = cells + column * geometry.rows;
+            QRgb *pixel = pixels + (geometry.rows - 1) * stride + column;
+            for (int row = 0; row < geometry.rows; ++row, pixel -= stride) {
+                if (cell[row]) {
+                    QRgb color = palette[levels[cell[row]]];
+                    *pixel = *pixel ? addLight(*pixel, color) : color;
+                }
+            }
+        }
+    }
+
+    painter->drawImage(QRectF(mParentPlot->axisRect()->rect()), image);
+}
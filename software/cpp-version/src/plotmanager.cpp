@@ -1,11 +1,20 @@
+#include <QThread>
+#include <cmath>
+#include <climits>
+#include <utility>
+
 #include "plotmanager.h"
 
-PlotManager::PlotManager(QCustomPlot *plot, int channels, int maxPoints, QObject *parent) : QObject(parent), plot(plot), channelCount(channels), maxPlotPoints(maxPoints) {
+PlotManager::PlotManager(QCustomPlot *plot, int channels, int maxPoints, QObject *parent) : QObject(parent), plot(plot), channelCount(channels), maxPlotPoints(maxPoints), traceLayer(nullptr), traceRaster(nullptr), phosphorView(nullptr), phosphor(nullptr), staticLayersValid(false), glView(nullptr), followLive(true), replots(0), timeBaseValid(false), timeOrigin(0), timePeriod(1), replotNsecs(0) {
     colors = {
         QColor(255, 82, 82),   // Modern red (Channel 1)
         QColor(33, 150, 243),  // Modern blue (Channel 2)
         QColor(76, 175, 80),   // Modern green (Channel 3)
-        QColor(255, 193, 7)    // Modern amber (Channel 4)
+        QColor(255, 193, 7),   // Modern amber (Channel 4)
+        QColor(171, 71, 188),  // Modern purple (Channel 5)
+        QColor(0, 188, 212),   // Modern cyan (Channel 6)
+        QColor(255, 112, 67),  // Modern orange (Channel 7)
+        QColor(236, 64, 122)   // Modern pink (Channel 8)
     };
 }
 
@@ -14,8 +23,6 @@ PlotManager::~PlotManager(void) {
 }
 
 void PlotManager::setupPlot(void) {
-    plotItems.clear();
-    
     plot->setNotAntialiasedElements(QCP::aeAll);
     plot->setNoAntialiasingOnDrag(true);
     plot->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom);
@@ -27,26 +34,27 @@ void PlotManager::setupPlot(void) {
     
     plot->setAttribute(Qt::WA_OpaquePaintEvent);
     
+    // The traces get a paint buffer of their own so a new frame of data does
+    // not repaint the grid, axes and tick labels.
+    traceLayer = plot->layer("main");
+    traceLayer->setMode(QCPLayer::lmBuffered);
+    
     connect(plot->xAxis, SIGNAL(rangeChanged(QCPRange)), this, SLOT(onXRangeChanged(QCPRange)));
     connect(plot->yAxis, SIGNAL(rangeChanged(QCPRange)), this, SLOT(onYRangeChanged(QCPRange)));
+    connect(plot, SIGNAL(mousePress(QMouseEvent*)), this, SLOT(onUserInteraction()));
+    connect(plot, SIGNAL(mouseWheel(QWheelEvent*)), this, SLOT(onUserInteraction()));
     
     plot->axisRect()->setMinimumMargins(QMargins(5, 5, 5, 5));
     plot->axisRect()->setMargins(QMargins(10, 10, 10, 10));
     
-    for (int i = 0; i < channelCount; ++i) {
-        QColor color = colors[i % colors.size()];
-        QPen pen(color, 2);
-        
-        plot->addGraph();
-        plot->graph(i)->setPen(pen);
-        plot->graph(i)->setVisible(i == 0);
-        plot->graph(i)->setAdaptiveSampling(true);
-        plot->graph(i)->setLineStyle(QCPGraph::lsLine);
-        plot->graph(i)->setScatterStyle(QCPScatterStyle::ssNone);
-        
-        plotItems.append(plot->graph(i));
+    // With more than one core the traces are drawn by worker threads.
+    if (QThread::idealThreadCount() > 1) {
+        traceRaster = new TraceRaster(plot);
     }
     
+    createGraphs();
+    phosphorView = new PhosphorView(plot);
+    
     plot->xAxis->setRange(0, maxPlotPoints);
     plot->yAxis->setRange(0, 1023);
     
@@ -59,7 +67,7 @@ void PlotManager::setupPlot(void) {
     
     plot->xAxis->setLabelFont(axisFont);
     plot->yAxis->setLabelFont(axisFont);
-    plot->xAxis->setLabel("Time (ms)");
+    plot->xAxis->setLabel("Sample");
     plot->yAxis->setLabel("Voltage (V)");
     
     plot->xAxis->setLabelColor(QColor(240, 240, 240));
@@ -88,62 +96,218 @@ void PlotManager::setupPlot(void) {
     plot->yAxis->grid()->setZeroLinePen(QPen(QColor(0, 120, 212)));
 }
 
-void PlotManager::updatePlotData(const QVector<QVector<double>> &data, const QVector<double> &xData, int currentLength, const QVector<bool> &channelVisibility) {
-    plot->setUpdatesEnabled(false);
+void PlotManager::createGraphs(void) {
+    plot->clearPlottables();
+    plotItems.clear();
     
-    static bool isDragging = false;
-    if (plot->xAxis->selectedParts() != QCPAxis::spNone || plot->yAxis->selectedParts() != QCPAxis::spNone) {
-        isDragging = true;
-        plot->setNotAntialiasedElements(QCP::aeAll);
-        return;
-    } else if (isDragging) {
-        isDragging = false;
-        plot->replot();
+    for (int i = 0; i < channelCount; ++i) {
+        QColor color = colors[i % colors.size()];
+        QPen pen(color, 2);
+        
+        StoreTrace *trace = new StoreTrace(plot->xAxis, plot->yAxis);
+        plot->addPlottable(trace);
+        trace->setPen(pen);
+        trace->setVisible(i == 0);
+        
+        plotItems.append(trace);
+    }
+    attachRenderers();
+}
+
+// OpenGL, when enabled, takes over from the worker threads.
+void PlotManager::attachRenderers(void) {
+    for (auto plotItem : plotItems) {
+        plotItem->setGlView(glView);
+        plotItem->setRasterized(traceRaster && !glView);
     }
+    if (traceRaster) {
+        traceRaster->setTraces(plotItems);
+    }
+}
 
-    bool hasData = false;
-    for (const auto &channel : data) {
-        if (!channel.isEmpty()) {
-            hasData = true;
-            break;
-        }
+void PlotManager::setChannelCount(int channels) {
+    if (channels == channelCount) {
+        return;
     }
+    channelCount = channels;
+    createGraphs();
+    plot->replot();
+}
 
-    if (hasData) {
-        for (int i = 0; i < channelCount; ++i) {
-            if (channelVisibility[i]) {
-                int startIdx = maxPlotPoints - currentLength;
-                QVector<double> visibleYData(data[i].mid(startIdx));
-                QVector<double> visibleXData(xData.mid(startIdx));
-                
-                plotItems[i]->setData(visibleXData, visibleYData);
-            }
-        }
+bool PlotManager::setOpenGl(bool enabled, QString *error) {
+    if (enabled == usesOpenGl()) {
+        return true;
+    }
+    if (!enabled) {
+        disconnect(plot, SIGNAL(beforeReplot()), this, SLOT(beginGlFrame()));
+        disconnect(plot, SIGNAL(afterReplot()), this, SLOT(endGlFrame()));
+        glView->deleteLater();
+        glView = nullptr;
     } else {
-        for (auto plotItem : plotItems) {
-            plotItem->data()->clear();
+        if (!GlTraceView::isSupported(error)) {
+            return false;
         }
+        glView = new GlTraceView(plot);
+        glView->setGeometry(plot->axisRect()->rect());
+        connect(plot, SIGNAL(beforeReplot()), this, SLOT(beginGlFrame()));
+        connect(plot, SIGNAL(afterReplot()), this, SLOT(endGlFrame()));
+        connect(glView, SIGNAL(failed(QString)), this, SLOT(glViewFailed(QString)));
+        glView->show();
     }
-    
-    static QElapsedTimer updateTimer;
-    if (updateTimer.isValid() && updateTimer.elapsed() < 33) {
+    attachRenderers();
+    plot->replot();
+    return true;
+}
+
+void PlotManager::beginGlFrame(void) {
+    if (glView) {
+        glView->beginFrame();
+    }
+}
+
+void PlotManager::endGlFrame(void) {
+    if (glView) {
+        glView->endFrame(plot->axisRect()->rect());
+    }
+}
+
+void PlotManager::glViewFailed(const QString &error) {
+    setOpenGl(false);
+    emit openGlFailed(error);
+}
+
+// The traces come back on the next data update, following the live data again.
+void PlotManager::setPersistence(Phosphor *newPhosphor) {
+    phosphor = newPhosphor;
+    phosphorView->setPhosphor(phosphor);
+    if (!phosphor) {
+        followLive = true;
+    }
+}
+
+void PlotManager::setTimeBase(double origin, double period) {
+    if (period <= 0) {
+        clearTimeBase();
+        return;
+    }
+    if (!timeBaseValid) {
+        QCPRange range = plot->xAxis->range();
+        timeBaseValid = true;
+        timeOrigin = origin;
+        timePeriod = period;
+        plot->xAxis->setLabel("Time (s)");
+        staticLayersValid = false;
+        plot->xAxis->setRange(xOf(range.lower), xOf(range.upper));
+        return;
+    }
+    timeOrigin = origin;
+    timePeriod = period;
+}
+
+void PlotManager::clearTimeBase(void) {
+    if (!timeBaseValid) {
+        return;
+    }
+    QCPRange range = plot->xAxis->range();
+    QCPRange samples(indexOf(range.lower), indexOf(range.upper));
+    timeBaseValid = false;
+    plot->xAxis->setLabel("Sample");
+    staticLayersValid = false;
+    plot->xAxis->setRange(samples);
+}
+
+void PlotManager::updatePlotData(const SampleStore &store, qint64 currentLength, const QVector<bool> &channelVisibility) {
+    // While an axis is held the plot replots itself as it moves.
+    if (plot->xAxis->selectedParts() != QCPAxis::spNone || plot->yAxis->selectedParts() != QCPAxis::spNone) {
+        plot->setNotAntialiasedElements(QCP::aeAll);
         return;
     }
-    updateTimer.restart();
+
+    if (phosphor) {
+        // Time since the trigger; the phosphor starts over whenever what one
+        // of its cells covers changes.
+        plot->xAxis->setRange(0, currentLength * (timeBaseValid ? timePeriod : 1.0));
+        PhosphorGeometry geometry;
+        geometry.columns = plot->axisRect()->width();
+        geometry.rows = plot->axisRect()->height();
+        geometry.sweepLength = currentLength;
+        geometry.lower = plot->yAxis->range().lower;
+        geometry.upper = plot->yAxis->range().upper;
+        phosphor->setGeometry(geometry);
+        phosphor->setTrigger(channelVisibility.indexOf(true), plot->yAxis->range().center());
+        phosphorView->setChannels(colors, channelVisibility);
+    } else if (followLive) {
+        double end = qMax(store.endIndex(), currentLength);
+        // Moving by whole pixel columns lets the raster scroll its last frame.
+        if (traceRaster && !glView) {
+            double samples = double(currentLength) / qMax(1, plot->axisRect()->width());
+            end = std::floor(end / samples) * samples;
+        }
+        plot->xAxis->setRange(xOf(end - currentLength), xOf(end));
+    }
+    if (traceRaster) {
+        traceRaster->setScrolling(followLive && !phosphor);
+    }
     
-    plot->setUpdatesEnabled(true);
+    // The traces read the store when the plot is drawn; nothing is copied here.
+    for (int i = 0; i < channelCount; ++i) {
+        plotItems[i]->setStore(&store, i);
+        plotItems[i]->setTimeBase(xOf(0), timeBaseValid ? timePeriod : 1.0);
+        plotItems[i]->setVisible(channelVisibility[i] && !phosphor);
+    }
     
+    QElapsedTimer replotTimer;
+    replotTimer.start();
+    replotData();
+    replotNsecs += replotTimer.nsecsElapsed();
+    ++replots;
+}
+
+// Laying the plot out sets up the ticks for the new ranges without drawing
+// anything. If no tick moved by a pixel the grid and axes are left as they
+// were drawn: a static or paused view, or a live one scrolling by less than a
+// pixel per frame. A faster scroll moves the ticks every frame, and every
+// frame is a full replot.
+void PlotManager::replotData(void) {
+    plot->updateLayout();
+    findTickPixels();
+    QVector<QString> tickLabels = plot->xAxis->tickVectorLabels() + plot->yAxis->tickVectorLabels();
+    QRect axisRect = plot->axisRect()->rect();
+    if (staticLayersValid && tickPixels == drawnTickPixels && tickLabels == drawnTickLabels && axisRect == drawnAxisRect && plot->size() == drawnSize) {
+        traceLayer->replot();
+        return;
+    }
     plot->replot();
+    std::swap(tickPixels, drawnTickPixels);
+    drawnTickLabels = tickLabels;
+    drawnAxisRect = axisRect;
+    drawnSize = plot->size();
+    staticLayersValid = true;
+}
+
+// Ticks and grid lines are drawn without antialiasing, so they land on whole
+// pixels; INT_MIN separates the axes and their sub-ticks.
+void PlotManager::findTickPixels(void) {
+    tickPixels.resize(0);
+    for (QCPAxis *axis : { plot->xAxis, plot->yAxis }) {
+        for (const QVector<double> &ticks : { axis->tickVector(), axis->subTickVector() }) {
+            for (double tick : ticks) {
+                tickPixels.append(qRound(axis->coordToPixel(tick)));
+            }
+            tickPixels.append(INT_MIN);
+        }
+    }
 }
 
 void PlotManager::clearPlot(void) {
     for (auto plotItem : plotItems) {
-        plotItem->data()->clear();
+        plotItem->clearData();
     }
     plot->replot();
 }
 
 void PlotManager::autoPosition(void) {
+    followLive = true;
     plot->rescaleAxes();
     plot->replot();
 }
@@ -154,13 +318,17 @@ void PlotManager::onXRangeChanged(const QCPRange &range) {
     if (boundedRange.lower < 0)
         boundedRange.lower = 0;
     
-    double minRange = 10;
+    double minRange = 10 * (timeBaseValid ? timePeriod : 1.0);
     if (boundedRange.size() < minRange) {
         boundedRange.upper = qMax(boundedRange.lower + minRange, boundedRange.center() + minRange / 2);
         boundedRange.lower = qMax(0.0, boundedRange.upper - minRange);
     }
     
     plot->xAxis->setRange(boundedRange);
+    
+    if (!followLive) {
+        emit viewRangeChanged();
+    }
 }
 
 void PlotManager::onYRangeChanged(const QCPRange &range) {
@@ -177,4 +345,7 @@ void PlotManager::onYRangeChanged(const QCPRange &range) {
     }
     
     plot->yAxis->setRange(boundedRange);
-}
\ No newline at end of file
+}
+void PlotManager::onUserInteraction(void) {
+    followLive = false;
+}
@@ -0,0 +1,154 @@
+#include <QSerialPortInfo>
+#include <QElapsedTimer>
+#include <cstring>
+
+#include "portwatcher.h"
+
+#ifdef Q_OS_LINUX
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <poll.h>
+#include <unistd.h>
+
+#define PORT_WATCH_EVENT_BYTES 8192
+#endif
+
+PortWatcher::PortWatcher(QObject *parent) : QThread(parent), stopRequested(0), pauseRequested(0), scanRequested(0), eventDriven(0) {
+}
+
+PortWatcher::~PortWatcher(void) {
+    stop();
+}
+
+void PortWatcher::stop(void) {
+    stopRequested.storeRelease(1);
+    wait();
+}
+
+void PortWatcher::setPaused(bool paused) {
+    pauseRequested.storeRelease(paused ? 1 : 0);
+}
+
+void PortWatcher::requestScan(void) {
+    scanRequested.storeRelease(1);
+}
+
+// Subscribes to the kernel's uevent broadcast; returns -1 where that is not
+// available, in which case the caller polls.
+int PortWatcher::openEvents(void) {
+#ifdef Q_OS_LINUX
+    int fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_KOBJECT_UEVENT);
+    if (fd < 0) {
+        return -1;
+    }
+
+    struct sockaddr_nl address;
+    memset(&address, 0, sizeof(address));
+    address.nl_family = AF_NETLINK;
+    address.nl_groups = 1;
+    if (bind(fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) < 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+#else
+    return -1;
+#endif
+}
+
+// Each message is "action@devpath" followed by NUL separated KEY=VALUE pairs;
+// only ttys coming and going change the port list.
+bool PortWatcher::readEvents(int fd) {
+    bool relevant = false;
+#ifdef Q_OS_LINUX
+    char buffer[PORT_WATCH_EVENT_BYTES];
+    ssize_t size;
+    while ((size = recv(fd, buffer, sizeof(buffer) - 1, 0)) > 0) {
+        buffer[size] = '\0';
+        if (strncmp(buffer, "add@", 4) != 0 && strncmp(buffer, "remove@", 7) != 0) {
+            continue;
+        }
+        for (const char *field = buffer; field < buffer + size; field += strlen(field) + 1) {
+            if (strcmp(field, "SUBSYSTEM=tty") == 0) {
+                relevant = true;
+                break;
+            }
+        }
+    }
+#else
+    Q_UNUSED(fd);
+#endif
+    return relevant;
+}
+
+void PortWatcher::scan(void) {
+    QStringList current;
+    const auto ports = QSerialPortInfo::availablePorts();
+    for (const QSerialPortInfo &port : ports) {
+        current << port.portName();
+    }
+
+    QStringList added;
+    for (const QString &port : current) {
+        if (!known.contains(port)) {
+            added << port;
+        }
+    }
+    QStringList removed;
+    for (const QString &port : known) {
+        if (!current.contains(port)) {
+            removed << port;
+        }
+    }
+
+    known = current;
+    if (!added.isEmpty() || !removed.isEmpty()) {
+        emit portsChanged(added, removed);
+    }
+}
+
+void PortWatcher::run(void) {
+    int fd = openEvents();
+    eventDriven.storeRelease(fd >= 0);
+
+    // The first scan always runs, then an event (or the poll interval) marks
+    // the list as stale; events are given PORT_WATCH_SETTLE_MS to finish
+    // arriving so that a device bringing up several ttys is scanned once.
+    bool stale = true;
+    QElapsedTimer staleSince;
+    staleSince.start();
+    QElapsedTimer lastScan;
+    lastScan.start();
+
+    while (!stopRequested.loadAcquire()) {
+        bool paused = pauseRequested.loadAcquire();
+        bool forced = scanRequested.fetchAndStoreAcquire(0);
+        bool settled = staleSince.elapsed() >= PORT_WATCH_SETTLE_MS || known.isEmpty();
+        if (forced || (stale && settled && !paused)) {
+            scan();
+            stale = false;
+            lastScan.restart();
+        }
+
+#ifdef Q_OS_LINUX
+        if (fd >= 0) {
+            struct pollfd pending = {fd, POLLIN, 0};
+            if (poll(&pending, 1, PORT_WATCH_WAIT_MS) > 0 && readEvents(fd)) {
+                stale = true;
+                staleSince.restart();
+            }
+            continue;
+        }
+#endif
+        msleep(PORT_WATCH_WAIT_MS);
+        if (!paused && lastScan.elapsed() >= PORT_WATCH_POLL_MS) {
+            stale = true;
+        }
+    }
+
+#ifdef Q_OS_LINUX
+    if (fd >= 0) {
+        ::close(fd);
+    }
+#endif
+}
@@ -0,0 +1,66 @@
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "ptysource.h"
+
+PtySource::PtySource(int channels, QObject *parent) : StreamSource(channels, parent), masterFd(-1), slaveFd(-1) {
+}
+
+PtySource::~PtySource(void) {
+    close();
+}
+
+bool PtySource::open(QString *error) {
+    close();
+
+    masterFd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (masterFd < 0 || grantpt(masterFd) != 0 || unlockpt(masterFd) != 0) {
+        if (error) {
+            *error = QString("Error creating pseudo-terminal: %1").arg(strerror(errno));
+        }
+        close();
+        return false;
+    }
+
+    slave = QString::fromLocal8Bit(ptsname(masterFd));
+
+    // Holding the slave open keeps reads from failing with EIO between writers.
+    slaveFd = ::open(slave.toLocal8Bit().constData(), O_RDWR | O_NOCTTY);
+    if (slaveFd >= 0) {
+        struct termios attributes;
+        if (tcgetattr(slaveFd, &attributes) == 0) {
+            cfmakeraw(&attributes);
+            tcsetattr(slaveFd, TCSANOW, &attributes);
+        }
+    }
+
+    fcntl(masterFd, F_SETFL, fcntl(masterFd, F_GETFL) | O_NONBLOCK);
+    resetStream();
+    return true;
+}
+
+void PtySource::close(void) {
+    if (slaveFd >= 0) {
+        ::close(slaveFd);
+        slaveFd = -1;
+    }
+    if (masterFd >= 0) {
+        ::close(masterFd);
+        masterFd = -1;
+    }
+}
+
+qint64 PtySource::readBytes(char *data, qint64 maxSize) {
+    ssize_t size = ::read(masterFd, data, maxSize);
+    return size > 0 ? size : 0;
+}
+
+void PtySource::waitForData(int msecs) {
+    struct pollfd descriptor = { masterFd, POLLIN, 0 };
+    poll(&descriptor, 1, msecs);
+}
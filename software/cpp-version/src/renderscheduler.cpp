@@ -0,0 +1,110 @@
+#include <QtMath>
+
+#include "renderscheduler.h"
+
+static const int histogramLimits[RENDER_HISTOGRAM_BUCKETS - 1] = { 17, 33, 50, 100, 250 };
+
+RenderScheduler::RenderScheduler(QObject *parent) : QObject(parent), periodNsecs(1000000000LL / RENDER_DEFAULT_REFRESH_HZ), divisor(1), running(false), pending(false), lastFrame(-1), smoothedCost(0) {
+    timer.setSingleShot(true);
+    timer.setTimerType(Qt::PreciseTimer);
+    connect(&timer, &QTimer::timeout, this, &RenderScheduler::tick);
+    clock.start();
+}
+
+void RenderScheduler::start(void) {
+    running = true;
+    lastFrame = -1;
+    schedule();
+}
+
+void RenderScheduler::stop(void) {
+    running = false;
+    if (!pending) {
+        timer.stop();
+    }
+}
+
+void RenderScheduler::setRefreshRate(double hz) {
+    if (hz > 0) {
+        periodNsecs = qint64(1e9 / hz);
+    }
+}
+
+void RenderScheduler::requestFrame(void) {
+    if (pending) {
+        ++counters.coalesced;
+        return;
+    }
+    pending = true;
+    if (!timer.isActive()) {
+        schedule();
+    }
+}
+
+double RenderScheduler::targetFps(void) const {
+    return 1e9 / (double(periodNsecs) * divisor);
+}
+
+RenderStats RenderScheduler::stats(void) const {
+    RenderStats current = counters;
+    current.targetFps = targetFps();
+    current.renderMsecs = smoothedCost / 1e6;
+    return current;
+}
+
+int RenderScheduler::bucketLimit(int bucket) {
+    return bucket >= 0 && bucket < RENDER_HISTOGRAM_BUCKETS - 1 ? histogramLimits[bucket] : 0;
+}
+
+// The next refresh slot on the scheduler's own grid. Qt gives widgets no
+// vsync phase, so the grid only has the display's period; the OpenGL view
+// swaps on vsync and absorbs the offset.
+void RenderScheduler::schedule(void) {
+    if (!running && !pending) {
+        return;
+    }
+    qint64 now = clock.nsecsElapsed();
+    qint64 next = (now / periodNsecs + 1) * periodNsecs;
+    timer.start(int((next - now + 999999) / 1000000));
+}
+
+void RenderScheduler::tick(void) {
+    if (running) {
+        emit poll();
+    }
+
+    // Half a period of slack so timer jitter does not skip a whole slot.
+    qint64 now = clock.nsecsElapsed();
+    if (pending && (lastFrame < 0 || now - lastFrame >= divisor * periodNsecs - periodNsecs / 2)) {
+        pending = false;
+        // On-demand frames while stopped are not paced, so they stay out of
+        // the histogram.
+        if (running && lastFrame >= 0) {
+            record(now - lastFrame);
+        }
+        lastFrame = now;
+        emit render();
+        adapt(clock.nsecsElapsed() - now);
+        ++counters.frames;
+    }
+    schedule();
+}
+
+void RenderScheduler::adapt(qint64 costNsecs) {
+    smoothedCost = smoothedCost <= 0 ? costNsecs : smoothedCost + RENDER_COST_SMOOTHING * (costNsecs - smoothedCost);
+
+    double refreshes = smoothedCost / (RENDER_BUDGET * periodNsecs);
+    if (refreshes > divisor) {
+        divisor = qMin(RENDER_MAX_DIVISOR, qCeil(refreshes));
+    } else if (divisor > 1 && refreshes < (divisor - 1) * RENDER_HYSTERESIS) {
+        divisor = qMax(1, qCeil(refreshes / RENDER_HYSTERESIS));
+    }
+}
+
+void RenderScheduler::record(qint64 frameNsecs) {
+    int bucket = 0;
+    while (bucket < RENDER_HISTOGRAM_BUCKETS - 1 && frameNsecs > histogramLimits[bucket] * 1000000LL) {
+        ++bucket;
+    }
+    ++counters.histogram[bucket];
+}
@@ -0,0 +1,152 @@
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <cstring>
+
+#include "sampleserver.h"
+
+SampleServer::SampleServer(QObject *parent) : QObject(parent), tcpServer(nullptr), localServer(nullptr), nextFrame(0), dropped(0) {
+    setScales(QVector<ChannelScale>());
+}
+
+SampleServer::~SampleServer(void) {
+    close();
+}
+
+bool SampleServer::listen(const QString &address, QString *error) {
+    close();
+
+    bool isPort;
+    quint16 port = address.toUShort(&isPort);
+    if (isPort) {
+        tcpServer = new QTcpServer(this);
+        if (!tcpServer->listen(QHostAddress::LocalHost, port)) {
+            if (error) {
+                *error = tcpServer->errorString();
+            }
+            close();
+            return false;
+        }
+        connect(tcpServer, SIGNAL(newConnection()), this, SLOT(acceptConnections()));
+        serverAddress = QString("localhost:%1").arg(tcpServer->serverPort());
+    } else {
+        // A socket file left behind by a crashed instance would block listen().
+        QLocalServer::removeServer(address);
+        localServer = new QLocalServer(this);
+        if (!localServer->listen(address)) {
+            if (error) {
+                *error = localServer->errorString();
+            }
+            close();
+            return false;
+        }
+        connect(localServer, SIGNAL(newConnection()), this, SLOT(acceptConnections()));
+        serverAddress = localServer->fullServerName();
+    }
+
+    nextFrame = 0;
+    dropped = 0;
+    return true;
+}
+
+void SampleServer::close(void) {
+    for (Subscriber &subscriber : subscribers) {
+        subscriber.socket->disconnect(this);
+        subscriber.socket->close();
+        subscriber.socket->deleteLater();
+    }
+    subscribers.clear();
+
+    delete tcpServer;
+    tcpServer = nullptr;
+    delete localServer;
+    localServer = nullptr;
+    serverAddress.clear();
+}
+
+void SampleServer::setScales(const QVector<ChannelScale> &scales) {
+    ServerHello header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SERVER_MAGIC, sizeof(header.magic));
+    header.version = SERVER_VERSION;
+    header.channels = qMin(scales.size(), CAPTURE_MAX_CHANNELS);
+    for (int i = 0; i < int(header.channels); ++i) {
+        CaptureCalibration &calibration = header.calibration[i];
+        calibration.gain = scales[i].gain;
+        calibration.offset = scales[i].offset;
+        QByteArray unit = scales[i].unit.toUtf8().left(sizeof(calibration.unit) - 1);
+        memcpy(calibration.unit, unit.constData(), unit.size());
+    }
+    hello = QByteArray(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    for (Subscriber &subscriber : subscribers) {
+        subscriber.socket->write(hello);
+    }
+}
+
+void SampleServer::publish(const int16_t *frames, const qint64 *timestamps, int count, int channels) {
+    if (subscribers.isEmpty() || count <= 0) {
+        nextFrame += count;
+        return;
+    }
+
+    ServerBlockHeader header;
+    header.magic = SERVER_BLOCK_MAGIC;
+    header.frames = count;
+    header.channels = channels;
+    header.firstFrame = nextFrame;
+    nextFrame += count;
+
+    int timestampBytes = count * sizeof(qint64);
+    int sampleBytes = count * channels * sizeof(int16_t);
+    payload.resize(timestampBytes + sampleBytes);
+    memcpy(payload.data(), timestamps, timestampBytes);
+    memcpy(payload.data() + timestampBytes, frames, sampleBytes);
+
+    qint64 messageSize = sizeof(header) + payload.size();
+    for (Subscriber &subscriber : subscribers) {
+        if (subscriber.socket->bytesToWrite() + messageSize > SERVER_QUEUE_BYTES) {
+            subscriber.pendingDrop += count;
+            dropped += count;
+            continue;
+        }
+        header.dropped = subscriber.pendingDrop;
+        subscriber.pendingDrop = 0;
+        subscriber.socket->write(reinterpret_cast<const char*>(&header), sizeof(header));
+        subscriber.socket->write(payload);
+    }
+}
+
+void SampleServer::acceptConnections(void) {
+    if (tcpServer) {
+        while (QTcpSocket *socket = tcpServer->nextPendingConnection()) {
+            socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+            addSubscriber(socket);
+        }
+    }
+    if (localServer) {
+        while (QLocalSocket *socket = localServer->nextPendingConnection()) {
+            addSubscriber(socket);
+        }
+    }
+}
+
+void SampleServer::addSubscriber(QIODevice *socket) {
+    connect(socket, SIGNAL(disconnected()), this, SLOT(removeSubscriber()));
+    socket->write(hello);
+    subscribers.append({ socket, 0 });
+}
+
+void SampleServer::removeSubscriber(void) {
+    QIODevice *socket = qobject_cast<QIODevice*>(sender());
+    for (int i = 0; i < subscribers.size(); ++i) {
+        if (subscribers[i].socket == socket) {
+            subscribers.remove(i);
+            break;
+        }
+    }
+    if (socket) {
+        socket->deleteLater();
+    }
+}
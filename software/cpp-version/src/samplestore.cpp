@@ -0,0 +1,207 @@
+#include <QtGlobal>
+
+#include "samplestore.h"
+
+static void convertCounts(const int16_t *__restrict src, qint64 count, double gain, double offset, double *__restrict out) {
+    for (qint64 i = 0; i < count; ++i) {
+        out[i] = src[i] * gain + offset;
+    }
+}
+
+SampleStore::SampleStore(int channels, qint64 capacity) : channels(channels), first(0), end(0) {
+    blockCount = qMax<qint64>(1, (capacity + SAMPLE_BLOCK_SIZE - 1) / SAMPLE_BLOCK_SIZE);
+    blocks.resize(channels);
+    for (int i = 0; i < channels; ++i) {
+        blocks[i].fill(nullptr, blockCount);
+    }
+    scales.resize(channels);
+
+    // Only levels from PYRAMID_RAW_LEVEL up are kept; finer ones would never
+    // be read, shorter runs being scanned from the raw samples.
+    levels = 0;
+    while ((qint64(1) << (PYRAMID_SHIFT * (levels + 1))) <= this->capacity()) {
+        ++levels;
+        if (levels >= PYRAMID_RAW_LEVEL) {
+            levelSlots.append((this->capacity() >> (PYRAMID_SHIFT * levels)) + 1);
+        }
+    }
+    pyramid.resize(channels);
+    for (int i = 0; i < channels; ++i) {
+        pyramid[i].resize(levelSlots.size());
+    }
+}
+
+SampleStore::~SampleStore(void) {
+    for (auto &channelBlocks : blocks) {
+        for (int16_t *block : channelBlocks) {
+            qFreeAligned(block);
+        }
+    }
+}
+
+int16_t *SampleStore::blockFor(int channel, qint64 index) {
+    int16_t *&block = blocks[channel][(index / SAMPLE_BLOCK_SIZE) % blockCount];
+    if (!block) {
+        block = static_cast<int16_t*>(qMallocAligned(SAMPLE_BLOCK_SIZE * sizeof(int16_t), SAMPLE_BLOCK_ALIGNMENT));
+        Q_CHECK_PTR(block);
+    }
+    return block;
+}
+
+void SampleStore::append(const int16_t *frame) {
+    qint64 offset = end % SAMPLE_BLOCK_SIZE;
+    for (int i = 0; i < channels; ++i) {
+        blockFor(i, end)[offset] = frame[i];
+        updatePyramid(i, end, frame[i]);
+    }
+    ++end;
+
+    if (end - first > capacity()) {
+        // The block that was just entered overwrote the oldest one.
+        first = ((end - 1) / SAMPLE_BLOCK_SIZE - blockCount + 1) * SAMPLE_BLOCK_SIZE;
+    }
+}
+
+void SampleStore::updatePyramid(int channel, qint64 index, int16_t value) {
+    QVector<QVector<MinMax>> &channelLevels = pyramid[channel];
+    for (int k = 0; k < channelLevels.size(); ++k) {
+        int shift = PYRAMID_SHIFT * (PYRAMID_RAW_LEVEL + k);
+        QVector<MinMax> &level = channelLevels[k];
+        int slot = (index >> shift) % levelSlots[k];
+
+        if ((index & ((qint64(1) << shift) - 1)) == 0) {
+            if (slot == level.size()) {
+                level.append({value, value});
+            } else {
+                level[slot] = {value, value};
+            }
+            continue;
+        }
+
+        // A bucket contains the one below it: once a value fits, it fits everywhere above.
+        MinMax &bucket = level[slot];
+        if (value < bucket.min) {
+            bucket.min = value;
+        } else if (value > bucket.max) {
+            bucket.max = value;
+        } else {
+            break;
+        }
+    }
+}
+
+void SampleStore::clear(void) {
+    first = 0;
+    end = 0;
+    for (auto &channelLevels : pyramid) {
+        for (auto &level : channelLevels) {
+            level.resize(0);
+        }
+    }
+}
+
+int16_t SampleStore::rawAt(int channel, qint64 index) const {
+    Q_ASSERT(index >= first && index < end);
+    return blocks[channel][(index / SAMPLE_BLOCK_SIZE) % blockCount][index % SAMPLE_BLOCK_SIZE];
+}
+
+const int16_t *SampleStore::rawSpan(int channel, qint64 index, qint64 *available) const {
+    Q_ASSERT(index >= first && index < end);
+    qint64 offset = index % SAMPLE_BLOCK_SIZE;
+    *available = qMin<qint64>(SAMPLE_BLOCK_SIZE - offset, end - index);
+    return blocks[channel][(index / SAMPLE_BLOCK_SIZE) % blockCount] + offset;
+}
+
+void SampleStore::setScale(int channel, const ChannelScale &scale) {
+    scales[channel] = scale;
+}
+
+void SampleStore::toDouble(int channel, qint64 start, qint64 count, double *out) const {
+    Q_ASSERT(start >= first && start + count <= end);
+    const ChannelScale &s = scales[channel];
+    while (count > 0) {
+        qint64 available;
+        const int16_t *src = rawSpan(channel, start, &available);
+        available = qMin(available, count);
+        convertCounts(src, available, s.gain, s.offset, out);
+        out += available;
+        start += available;
+        count -= available;
+    }
+}
+
+void SampleStore::toDouble(int channel, qint64 start, qint64 count, QVector<double> &out) const {
+    out.resize(count);
+    toDouble(channel, start, count, out.data());
+}
+
+void SampleStore::decimate(int channel, const qint64 *bounds, int columns, ColumnM4 *out) const {
+    Q_ASSERT(columns > 0 && bounds[0] >= first && bounds[columns] <= end);
+    for (int c = 0; c < columns; ++c, ++out) {
+        qint64 lo = bounds[c];
+        qint64 hi = bounds[c + 1];
+        Q_ASSERT(lo < hi);
+        rangeMinMax(channel, lo, hi, &out->min, &out->max);
+        out->first = rawAt(channel, lo);
+        out->last = rawAt(channel, hi - 1);
+    }
+}
+
+void SampleStore::rawMinMax(int channel, qint64 lo, qint64 hi, int16_t *min, int16_t *max) const {
+    while (lo < hi) {
+        qint64 available;
+        const int16_t *span = rawSpan(channel, lo, &available);
+        available = qMin(available, hi - lo);
+        minMaxCounts(span, available, min, max);
+        lo += available;
+    }
+}
+
+// lo and hi are multiples of the level's bucket size.
+void SampleStore::bucketMinMax(int channel, int level, qint64 lo, qint64 hi, int16_t *min, int16_t *max) const {
+    const QVector<MinMax> &buckets = pyramid[channel][level - PYRAMID_RAW_LEVEL];
+    qint64 slots = levelSlots[level - PYRAMID_RAW_LEVEL];
+    int shift = PYRAMID_SHIFT * level;
+    for (qint64 b = lo >> shift; b < hi >> shift; ++b) {
+        const MinMax &bucket = buckets[b % slots];
+        *min = qMin(*min, bucket.min);
+        *max = qMax(*max, bucket.max);
+    }
+}
+
+// Climbs the pyramid from PYRAMID_RAW_LEVEL: at each level the range is trimmed
+// to the next level's bucket boundaries, the trimmed ends (at most three
+// buckets each) being taken from the current level, so a range of any length
+// touches a handful of buckets per level.
+void SampleStore::rangeMinMax(int channel, qint64 lo, qint64 hi, int16_t *min, int16_t *max) const {
+    Q_ASSERT(lo >= first && hi <= end && lo < hi);
+    *min = INT16_MAX;
+    *max = INT16_MIN;
+
+    int level = PYRAMID_RAW_LEVEL;
+    qint64 size = qint64(1) << (PYRAMID_SHIFT * level);
+    qint64 l = (lo + size - 1) / size * size;
+    qint64 h = hi / size * size;
+    if (levels < level || l >= h) {
+        rawMinMax(channel, lo, hi, min, max);
+        return;
+    }
+    rawMinMax(channel, lo, l, min, max);
+    rawMinMax(channel, h, hi, min, max);
+
+    while (true) {
+        qint64 next = size << PYRAMID_SHIFT;
+        qint64 nl = (l + next - 1) / next * next;
+        qint64 nh = h / next * next;
+        if (level == levels || nl >= nh) {
+            bucketMinMax(channel, level, l, h, min, max);
+            return;
+        }
+        bucketMinMax(channel, level, l, nl, min, max);
+        bucketMinMax(channel, level, nh, h, min, max);
+        l = nl;
+        h = nh;
+        size = next;
+        ++level;
+    }
+}
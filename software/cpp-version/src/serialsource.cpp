@@ -0,0 +1,41 @@
+#include "serialsource.h"
+
+SerialSource::SerialSource(const QString &portName, int baudRate, int channels, QObject *parent) : StreamSource(channels, parent) {
+    port = new QSerialPort(this);
+    port->setPortName(portName);
+    port->setBaudRate(baudRate);
+    port->setDataBits(QSerialPort::Data8);
+    port->setParity(QSerialPort::NoParity);
+    port->setStopBits(QSerialPort::OneStop);
+    port->setFlowControl(QSerialPort::NoFlowControl);
+}
+
+bool SerialSource::open(QString *error) {
+    if (port->isOpen()) {
+        port->close();
+    }
+
+    if (!port->open(QIODevice::ReadWrite)) {
+        if (error) {
+            *error = port->errorString();
+        }
+        return false;
+    }
+
+    resetStream();
+    return true;
+}
+
+void SerialSource::close(void) {
+    if (port->isOpen()) {
+        port->close();
+    }
+}
+
+void SerialSource::setBaudRate(int baudRate) {
+    port->setBaudRate(baudRate);
+}
+
+qint64 SerialSource::readBytes(char *data, qint64 maxSize) {
+    return port->read(data, maxSize);
+}
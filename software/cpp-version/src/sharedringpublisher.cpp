@@ -0,0 +1,147 @@
+#include <errno.h>
+#include <string.h>
+
+#include "sharedringpublisher.h"
+
+SharedRingPublisher::SharedRingPublisher(void) : header(nullptr), size(0), timestamps(nullptr), samples(nullptr), capacity(0) {
+}
+
+SharedRingPublisher::~SharedRingPublisher(void) {
+    close();
+}
+
+bool SharedRingPublisher::open(const QString &name, const QVector<ChannelScale> &scales, quint64 capacity, QString *error) {
+    close();
+
+    int channels = scales.size();
+    if (channels <= 0 || channels > SHARED_RING_MAX_CHANNELS) {
+        if (error) {
+            *error = QString("Unsupported channel count %1").arg(channels);
+        }
+        return false;
+    }
+
+    // Slots are addressed with a mask, so the capacity is rounded up to a power of two.
+    quint64 slots = 1;
+    while (slots < capacity) {
+        slots <<= 1;
+    }
+
+    quint64 timestampOffset = SHARED_RING_DATA_ALIGN;
+    quint64 sampleOffset = timestampOffset + slots * sizeof(int64_t);
+    quint64 totalSize = sampleOffset + slots * channels * sizeof(int16_t);
+
+    QByteArray path = name.toLocal8Bit();
+    if (!path.startsWith('/')) {
+        path.prepend('/');
+    }
+
+    shm_unlink(path.constData());
+    int fd = shm_open(path.constData(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0 || ftruncate(fd, totalSize) != 0) {
+        if (error) {
+            *error = QString("Error creating shared memory %1: %2").arg(QString::fromLocal8Bit(path), strerror(errno));
+        }
+        if (fd >= 0) {
+            ::close(fd);
+            shm_unlink(path.constData());
+        }
+        return false;
+    }
+
+    void *data = mmap(nullptr, totalSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        if (error) {
+            *error = QString("Error mapping shared memory %1: %2").arg(QString::fromLocal8Bit(path), strerror(errno));
+        }
+        shm_unlink(path.constData());
+        return false;
+    }
+
+    header = static_cast<SharedRingHeader*>(data);
+    memset(header, 0, sizeof(*header));
+    header->version = SHARED_RING_VERSION;
+    header->channels = channels;
+    header->capacity = slots;
+    header->timestampOffset = timestampOffset;
+    header->sampleOffset = sampleOffset;
+    header->totalSize = totalSize;
+    writeCalibration(scales);
+
+    size = totalSize;
+    timestamps = reinterpret_cast<int64_t*>(static_cast<char*>(data) + timestampOffset);
+    samples = reinterpret_cast<int16_t*>(static_cast<char*>(data) + sampleOffset);
+    segmentName = path;
+    this->capacity = slots;
+
+    // Readers validate the magic, so it goes in last.
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(header->magic, SHARED_RING_MAGIC, sizeof(header->magic));
+    return true;
+}
+
+void SharedRingPublisher::close(void) {
+    if (!header) {
+        return;
+    }
+    __atomic_store_n(&header->closed, 1u, __ATOMIC_RELEASE);
+    munmap(header, size);
+    shm_unlink(segmentName.constData());
+
+    header = nullptr;
+    timestamps = nullptr;
+    samples = nullptr;
+    size = 0;
+}
+
+bool SharedRingPublisher::setScales(const QVector<ChannelScale> &scales, QString *error) {
+    if (!header) {
+        return true;
+    }
+    if (int(header->channels) != scales.size()) {
+        return open(name(), scales, capacity, error);
+    }
+    writeCalibration(scales);
+    return true;
+}
+
+void SharedRingPublisher::writeCalibration(const QVector<ChannelScale> &scales) {
+    for (int i = 0; i < scales.size() && i < SHARED_RING_MAX_CHANNELS; ++i) {
+        SharedRingCalibration &calibration = header->calibration[i];
+        calibration.gain = scales[i].gain;
+        calibration.offset = scales[i].offset;
+        memset(calibration.unit, 0, sizeof(calibration.unit));
+        QByteArray unit = scales[i].unit.toUtf8().left(sizeof(calibration.unit) - 1);
+        memcpy(calibration.unit, unit.constData(), unit.size());
+    }
+}
+
+void SharedRingPublisher::publish(const int16_t *frames, const qint64 *timestamps, int count, int channels) {
+    if (!header || channels != int(header->channels) || count <= 0) {
+        return;
+    }
+
+    // Only the newest capacity frames of an oversized batch would survive anyway.
+    if (quint64(count) > capacity) {
+        frames += (count - capacity) * channels;
+        timestamps += count - capacity;
+        count = capacity;
+    }
+
+    quint64 first = header->writeIndex;
+    quint64 end = first + count;
+    __atomic_store_n(&header->claimIndex, end, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    quint64 slot = first & (capacity - 1);
+    quint64 head = qMin<quint64>(count, capacity - slot);
+    memcpy(this->timestamps + slot, timestamps, head * sizeof(int64_t));
+    memcpy(samples + slot * channels, frames, head * channels * sizeof(int16_t));
+    if (head < quint64(count)) {
+        memcpy(this->timestamps, timestamps + head, (count - head) * sizeof(int64_t));
+        memcpy(samples, frames + head * channels, (count - head) * channels * sizeof(int16_t));
+    }
+
+    __atomic_store_n(&header->writeIndex, end, __ATOMIC_RELEASE);
+}
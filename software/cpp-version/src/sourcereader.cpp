@@ -0,0 +1,123 @@
+#include <QMutexLocker>
+#include <utility>
+
+#include "sourcereader.h"
+
+SourceReader::SourceReader(DataSource *source, const QElapsedTimer *epoch, QObject *parent) : QThread(parent), source(source), owner(nullptr), epoch(epoch), openDone(false), openOk(false), stopRequested(0), ring(READER_QUEUE_BLOCKS), head(0), queuedBlocks(0), queuedFrames(0), dropped(0) {
+}
+
+SourceReader::~SourceReader(void) {
+    close();
+}
+
+bool SourceReader::open(QString *error) {
+    Q_ASSERT(!source->parent());
+    owner = QThread::currentThread();
+    source->moveToThread(this);
+
+    openDone = false;
+    stopRequested.storeRelease(0);
+    dropped.storeRelease(0);
+    start();
+
+    QMutexLocker locker(&mutex);
+    while (!openDone) {
+        opened.wait(&mutex);
+    }
+    if (!openOk) {
+        locker.unlock();
+        wait();
+        if (error) {
+            *error = openError;
+        }
+        return false;
+    }
+    return true;
+}
+
+void SourceReader::close(void) {
+    stopRequested.storeRelease(1);
+    {
+        QMutexLocker locker(&mutex);
+        spaceFree.wakeAll();
+    }
+    wait();
+
+    QMutexLocker locker(&mutex);
+    head = 0;
+    queuedBlocks = 0;
+    queuedFrames = 0;
+}
+
+bool SourceReader::takeBlock(FrameBlock &block) {
+    QMutexLocker locker(&mutex);
+    if (queuedBlocks == 0) {
+        return false;
+    }
+    std::swap(block, ring[head]);
+    head = (head + 1) % READER_QUEUE_BLOCKS;
+    --queuedBlocks;
+    queuedFrames -= block.count;
+    spaceFree.wakeOne();
+    return true;
+}
+
+int SourceReader::queuedFrameCount(void) {
+    QMutexLocker locker(&mutex);
+    return queuedFrames;
+}
+
+bool SourceReader::atEnd(void) {
+    QMutexLocker locker(&mutex);
+    return isFinished() && queuedBlocks == 0;
+}
+
+void SourceReader::run(void) {
+    QString error;
+    qint64 openedAt = epoch->nsecsElapsed();
+    bool ok = source->open(&error);
+    {
+        QMutexLocker locker(&mutex);
+        openDone = true;
+        openOk = ok;
+        openError = error;
+        opened.wakeAll();
+    }
+
+    if (ok) {
+        int channels = source->channelCount();
+        bool live = source->isLive();
+        FrameBlock block;
+        while (!stopRequested.loadAcquire()) {
+            block.frames.resize(READER_BATCH_FRAMES * channels);
+            block.timestamps.resize(READER_BATCH_FRAMES);
+            block.count = source->readFrames(block.frames.data(), block.timestamps.data(), READER_BATCH_FRAMES);
+            if (block.count == 0) {
+                if (source->atEnd()) {
+                    break;
+                }
+                source->waitForData(READER_WAIT_MS);
+                continue;
+            }
+
+            for (int i = 0; i < block.count; ++i) {
+                block.timestamps[i] += openedAt;
+            }
+
+            QMutexLocker locker(&mutex);
+            while (!live && !stopRequested.loadAcquire() && (queuedBlocks == READER_QUEUE_BLOCKS || queuedFrames + block.count > READER_QUEUE_FRAMES)) {
+                spaceFree.wait(&mutex);
+            }
+            if (queuedBlocks == READER_QUEUE_BLOCKS || queuedFrames + block.count > READER_QUEUE_FRAMES) {
+                dropped.fetchAndAddRelaxed(block.count);
+                continue;
+            }
+            queuedFrames += block.count;
+            std::swap(block, ring[(head + queuedBlocks) % READER_QUEUE_BLOCKS]);
+            ++queuedBlocks;
+        }
+        source->close();
+    }
+
+    source->moveToThread(owner);
+}
@@ -0,0 +1,196 @@
+#include <QtMath>
+#include <algorithm>
+
+#include "spectrogram.h"
+
+// One axis rect per channel replaces the plot's default one.
+Spectrogram::Spectrogram(QCustomPlot *plot, QObject *parent) : QObject(parent), plot(plot), marginGroup(nullptr), spectrum(SPECTROGRAM_FFT_SIZE), nextIndex(0), columnSamples(SPECTROGRAM_FFT_SIZE * SPECTROGRAM_MAX_FRAMES), samplePeriod(0), samples(SPECTROGRAM_FFT_SIZE), levels(spectrum.bins()), column(spectrum.bins()) {
+    plot->plotLayout()->clear();
+    plot->plotLayout()->setRowSpacing(4);
+    plot->setNotAntialiasedElements(QCP::aeAll);
+    plot->setBackground(QBrush(QColor(30, 30, 30)));
+    marginGroup = new QCPMarginGroup(plot);
+}
+
+void Spectrogram::setChannels(int count, const QVector<QColor> &colors) {
+    removeChannels();
+    for (int i = 0; i < count; ++i) {
+        Channel channel;
+        channel.rect = new QCPAxisRect(plot);
+        channel.rect->setVisible(false);
+        channel.rect->setMarginGroup(QCP::msLeft | QCP::msRight, marginGroup);
+        channel.shown = false;
+
+        QCPAxis *timeAxis = channel.rect->axis(QCPAxis::atBottom);
+        QCPAxis *frequencyAxis = channel.rect->axis(QCPAxis::atLeft);
+        for (QCPAxis *axis : { timeAxis, frequencyAxis }) {
+            axis->setBasePen(QPen(QColor(240, 240, 240)));
+            axis->setTickPen(QPen(QColor(240, 240, 240)));
+            axis->setSubTickPen(QPen(QColor(240, 240, 240)));
+            axis->setTickLabelColor(QColor(240, 240, 240));
+            axis->setLabelColor(QColor(240, 240, 240));
+            axis->grid()->setVisible(false);
+        }
+        frequencyAxis->setLabelColor(colors[i % colors.size()]);
+
+        channel.map = new QCPColorMap(timeAxis, frequencyAxis);
+        plot->addPlottable(channel.map);
+        channel.map->setGradient(QCPColorGradient::gpThermal);
+        channel.map->setInterpolate(false);
+        channel.map->data()->setSize(SPECTROGRAM_HISTORY_COLUMNS, spectrum.bins());
+        channels.append(channel);
+    }
+    setRanges();
+    clear();
+}
+
+// Rects taken out of the layout are not deleted with it.
+void Spectrogram::removeChannels(void) {
+    for (const Channel &channel : channels) {
+        plot->removePlottable(channel.map);
+        if (!channel.shown) {
+            delete channel.rect;
+        }
+    }
+    plot->plotLayout()->clear();
+    channels.clear();
+    shownChannels.clear();
+}
+
+// Only the visible channels get a row; the others keep their columns coming
+// so they are up to date when shown again.
+bool Spectrogram::layoutChannels(const QVector<bool> &visible) {
+    if (visible == shownChannels) {
+        return false;
+    }
+    shownChannels = visible;
+    for (const Channel &channel : channels) {
+        if (channel.shown) {
+            plot->plotLayout()->take(channel.rect);
+        }
+    }
+    plot->plotLayout()->simplify();
+    int row = 0;
+    for (int i = 0; i < channels.size(); ++i) {
+        channels[i].shown = i < visible.size() && visible[i];
+        channels[i].rect->setVisible(channels[i].shown);
+        if (channels[i].shown) {
+            plot->plotLayout()->addElement(row++, 0, channels[i].rect);
+        }
+    }
+    return true;
+}
+
+// Only the bottom row labels the time axis.
+void Spectrogram::setRanges(void) {
+    bool timeBase = samplePeriod > 0;
+    double columnWidth = columnSamples * (timeBase ? samplePeriod : 1.0);
+    double nyquist = timeBase ? 0.5 / samplePeriod : 0.5;
+    QCPRange keys(-(SPECTROGRAM_HISTORY_COLUMNS - 1) * columnWidth, 0);
+    int bottom = -1;
+    for (int i = 0; i < channels.size(); ++i) {
+        if (channels[i].shown) {
+            bottom = i;
+        }
+    }
+    for (int i = 0; i < channels.size(); ++i) {
+        QCPAxis *timeAxis = channels[i].rect->axis(QCPAxis::atBottom);
+        QCPAxis *frequencyAxis = channels[i].rect->axis(QCPAxis::atLeft);
+        channels[i].map->data()->setRange(keys, QCPRange(0, nyquist));
+        timeAxis->setRange(keys.lower - columnWidth / 2, keys.upper + columnWidth / 2);
+        timeAxis->setTickLabels(i == bottom);
+        timeAxis->setLabel(i == bottom ? (timeBase ? "Time (s)" : "Sample") : QString());
+        frequencyAxis->setRange(0, nyquist);
+        frequencyAxis->setLabel(QString("Ch %1 (%2)").arg(i + 1).arg(timeBase ? "Hz" : "1/sample"));
+    }
+}
+
+void Spectrogram::clear(void) {
+    restart();
+    plot->replot();
+}
+
+void Spectrogram::restart(void) {
+    for (const Channel &channel : channels) {
+        channel.map->data()->fill(SPECTRUM_FLOOR_DB);
+        channel.map->setDataRange(QCPRange(-SPECTROGRAM_DYNAMIC_RANGE_DB, 0));
+    }
+    nextIndex = 0;
+}
+
+void Spectrogram::update(const SampleStore &store, const QVector<bool> &channelVisibility, double period) {
+    // The period is an estimate that keeps moving a little; the columns only
+    // start over when their length really changes.
+    qint64 samplesPerColumn = period > 0 ? qMax<qint64>(SPECTROGRAM_FFT_SIZE, qRound64(SPECTROGRAM_COLUMN_SECONDS / period)) : SPECTROGRAM_FFT_SIZE * SPECTROGRAM_MAX_FRAMES;
+    bool restarted = false;
+    if (qAbs(samplesPerColumn - columnSamples) * 100 > columnSamples || (period > 0) != (samplePeriod > 0) || store.endIndex() < nextIndex) {
+        columnSamples = samplesPerColumn;
+        restart();
+        restarted = true;
+    }
+    samplePeriod = period;
+    bool changed = layoutChannels(channelVisibility) || restarted;
+    setRanges();
+
+    // Columns too far behind to catch up with, or that the store no longer
+    // has, stay empty, keeping the others in place.
+    qint64 end = store.endIndex();
+    qint64 oldest = qMax(store.firstIndex(), end - SPECTROGRAM_MAX_COLUMNS * columnSamples);
+    qint64 missed = (oldest - nextIndex + columnSamples - 1) / columnSamples;
+    if (missed >= SPECTROGRAM_HISTORY_COLUMNS) {
+        restart();
+        nextIndex = oldest;
+        changed = true;
+    } else if (missed > 0) {
+        column.fill(SPECTRUM_FLOOR_DB);
+        for (qint64 i = 0; i < missed; ++i) {
+            for (const Channel &channel : channels) {
+                channel.map->appendKeyColumn(column.constData());
+            }
+        }
+        nextIndex += missed * columnSamples;
+        changed = true;
+    }
+
+    // Every map gets a column each step, empty for a channel the store doesn't
+    // have, so all of them stay aligned on the same keys.
+    for (int i = 0; i < SPECTROGRAM_MAX_COLUMNS && nextIndex + columnSamples <= end; ++i) {
+        for (int c = 0; c < channels.size(); ++c) {
+            if (c < store.channelCount()) {
+                appendColumn(store, c, nextIndex);
+            } else {
+                column.fill(SPECTRUM_FLOOR_DB);
+                channels[c].map->appendKeyColumn(column.constData());
+            }
+        }
+        nextIndex += columnSamples;
+        changed = true;
+    }
+
+    if (changed) {
+        plot->replot();
+    }
+}
+
+// The colours follow the loudest column seen so far, with some headroom, so
+// changing them, which recolours the whole map, stays rare.
+void Spectrogram::appendColumn(const SampleStore &store, int channel, qint64 start) {
+    int frames = int(qBound<qint64>(1, columnSamples / SPECTROGRAM_FFT_SIZE, SPECTROGRAM_MAX_FRAMES));
+    qint64 room = columnSamples - SPECTROGRAM_FFT_SIZE;
+    column.fill(SPECTRUM_FLOOR_DB);
+    for (int f = 0; f < frames; ++f) {
+        qint64 from = start + (frames > 1 ? room * f / (frames - 1) : room / 2);
+        store.toDouble(channel, from, SPECTROGRAM_FFT_SIZE, samples.data());
+        spectrum.compute(samples.constData(), levels.data());
+        for (int k = 0; k < column.size(); ++k) {
+            column[k] = qMax(column[k], levels[k]);
+        }
+    }
+
+    QCPColorMap *map = channels[channel].map;
+    double peak = *std::max_element(column.constBegin(), column.constEnd());
+    if (peak > map->dataRange().upper) {
+        map->setDataRange(QCPRange(peak + SPECTROGRAM_HEADROOM_DB - SPECTROGRAM_DYNAMIC_RANGE_DB, peak + SPECTROGRAM_HEADROOM_DB));
+    }
+    map->appendKeyColumn(column.constData());
+}
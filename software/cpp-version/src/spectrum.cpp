@@ -0,0 +1,61 @@
+#include <QtMath>
+#include <cmath>
+
+#include "spectrum.h"
+
+Spectrum::Spectrum(int size) : n(size), window(size), windowGain(0), reversed(size), twiddles(size / 2), buffer(size) {
+    Q_ASSERT(size >= 2 && (size & (size - 1)) == 0);
+
+    for (int i = 0; i < n; ++i) {
+        window[i] = 0.5 - 0.5 * std::cos(2 * M_PI * i / n);
+        windowGain += window[i];
+    }
+
+    int bits = 0;
+    while ((1 << bits) < n) {
+        ++bits;
+    }
+    for (int i = 0; i < n; ++i) {
+        int r = 0;
+        for (int b = 0; b < bits; ++b) {
+            r |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        reversed[i] = r;
+    }
+
+    for (int k = 0; k < n / 2; ++k) {
+        twiddles[k] = std::polar(1.0, -2 * M_PI * k / n);
+    }
+}
+
+void Spectrum::compute(const double *samples, double *decibels) {
+    double mean = 0;
+    for (int i = 0; i < n; ++i) {
+        mean += samples[i];
+    }
+    mean /= n;
+    for (int i = 0; i < n; ++i) {
+        buffer[reversed[i]] = (samples[i] - mean) * window[i];
+    }
+
+    // Iterative Cooley-Tukey, butterflies of doubling span.
+    std::complex<double> *x = buffer.data();
+    for (int span = 1; span < n; span <<= 1) {
+        int stride = n / (2 * span);
+        for (int start = 0; start < n; start += 2 * span) {
+            for (int k = 0; k < span; ++k) {
+                std::complex<double> odd = twiddles[k * stride] * x[start + span + k];
+                x[start + span + k] = x[start + k] - odd;
+                x[start + k] += odd;
+            }
+        }
+    }
+
+    // A sine of amplitude a peaks at a * windowGain / 2.
+    double scale = 2.0 / windowGain;
+    double floor = std::pow(10.0, SPECTRUM_FLOOR_DB / 10);
+    for (int k = 0; k < bins(); ++k) {
+        double power = std::norm(x[k]) * scale * scale;
+        decibels[k] = 10 * std::log10(qMax(power, floor));
+    }
+}
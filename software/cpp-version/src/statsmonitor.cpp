@@ -0,0 +1,60 @@
+#include "statsmonitor.h"
+
+StatsMonitor::StatsMonitor(Acquisition *acquisition, PlotManager *plotManager, RenderScheduler *scheduler, QObject *parent) : QObject(parent), acquisition(acquisition), plotManager(plotManager), scheduler(scheduler), lastReplots(0), lastReplotTime(0) {
+    timer.setInterval(STATS_INTERVAL_MS);
+    connect(&timer, &QTimer::timeout, this, &StatsMonitor::sample);
+}
+
+void StatsMonitor::start(void) {
+    stats = PipelineStats();
+    lastReplots = plotManager->replotCount();
+    lastReplotTime = plotManager->replotTime();
+    lastHistogram = scheduler->stats().histogram;
+    clock.start();
+    timer.start();
+}
+
+void StatsMonitor::stop(void) {
+    timer.stop();
+}
+
+void StatsMonitor::sample(void) {
+    double seconds = clock.nsecsElapsed() / 1e9;
+    clock.start();
+    if (seconds <= 0) {
+        return;
+    }
+
+    AcquisitionStats current = acquisition->stats();
+    PipelineStats next;
+    next.bytes = current.source.bytes;
+    next.frames = current.frames;
+    next.parseErrors = current.source.parseErrors;
+    next.droppedBytes = current.source.droppedBytes;
+    next.droppedFrames = current.source.droppedFrames + current.writerDroppedFrames + current.serverDroppedFrames + current.phosphorDroppedFrames;
+    next.bufferedBytes = current.source.bufferedBytes;
+    next.queuedFrames = current.source.queuedFrames;
+
+    // Counters restart with each source, so a drop in a total is a new run.
+    next.bytesPerSecond = qMax<qint64>(0, next.bytes - stats.bytes) / seconds;
+    next.framesPerSecond = qMax<qint64>(0, next.frames - stats.frames) / seconds;
+    next.saturated = next.parseErrors > stats.parseErrors || next.droppedBytes > stats.droppedBytes || next.droppedFrames > stats.droppedFrames;
+
+    qint64 replots = plotManager->replotCount() - lastReplots;
+    qint64 replotTime = plotManager->replotTime() - lastReplotTime;
+    lastReplots = plotManager->replotCount();
+    lastReplotTime = plotManager->replotTime();
+    next.renderFps = replots / seconds;
+    next.replotMsecs = replots > 0 ? replotTime / 1e6 / replots : 0.0;
+
+    RenderStats render = scheduler->stats();
+    next.targetFps = render.targetFps;
+    next.frameTimes.resize(render.histogram.size());
+    for (int i = 0; i < render.histogram.size(); ++i) {
+        next.frameTimes[i] = render.histogram[i] - lastHistogram.value(i);
+    }
+    lastHistogram = render.histogram;
+
+    stats = next;
+    emit updated(stats);
+}
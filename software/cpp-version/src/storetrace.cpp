@@ -0,0 +1,187 @@
+#include "storetrace.h"
+#include "gltraceview.h"
+
+StoreTrace::StoreTrace(QCPAxis *keyAxis, QCPAxis *valueAxis) : QCPAbstractPlottable(keyAxis, valueAxis), sampleStore(nullptr), glView(nullptr), rasterized(false), storeChannel(0), timeOrigin(0), timePeriod(1) {
+}
+
+void StoreTrace::setStore(const SampleStore *store, int channel) {
+    sampleStore = store;
+    storeChannel = channel;
+}
+
+void StoreTrace::setTimeBase(double origin, double period) {
+    timeOrigin = origin;
+    timePeriod = period > 0 ? period : 1;
+}
+
+void StoreTrace::clearData(void) {
+    sampleStore = nullptr;
+    buffers.points.clear();
+}
+
+double StoreTrace::selectTest(const QPointF &pos, bool onlySelectable, QVariant *details) const {
+    Q_UNUSED(pos);
+    Q_UNUSED(onlySelectable);
+    Q_UNUSED(details);
+    return -1;
+}
+
+bool StoreTrace::visibleSpan(qint64 *start, qint64 *stop) const {
+    if (!sampleStore || sampleStore->isEmpty() || !mKeyAxis) {
+        return false;
+    }
+    QCPRange range = mKeyAxis.data()->range();
+    *start = qMax<qint64>(sampleStore->firstIndex(), qFloor(indexOf(range.lower)));
+    *stop = qMin<qint64>(sampleStore->endIndex(), qCeil(indexOf(range.upper)) + 1);
+    return *start < *stop;
+}
+
+void StoreTrace::buildSamples(qint64 start, qint64 stop, QVector<QPointF> *out) const {
+    const ChannelScale &scale = sampleStore->scale(storeChannel);
+    out->resize(stop - start);
+    QPointF *point = out->data();
+    for (qint64 i = start; i < stop;) {
+        qint64 available;
+        const int16_t *raw = sampleStore->rawSpan(storeChannel, i, &available);
+        available = qMin(available, stop - i);
+        for (qint64 j = 0; j < available; ++j) {
+            *point++ = coordsToPixels(keyOf(i + j), raw[j] * scale.gain + scale.offset);
+        }
+        i += available;
+    }
+}
+
+// Within a column the line goes from its first sample through both extremes
+// to its last one; the order of min and max does not matter since all four
+// points share the column. Edges are taken from the axis, not spread evenly
+// over the visible samples, so a column is the same wherever the range puts
+// it; columns with no samples, off either end of the store, are dropped.
+bool StoreTrace::buildColumns(int firstColumn, int lastColumn, PolylineBuffers *buffers) const {
+    QVector<qint64> &bounds = buffers->bounds;
+    bounds.resize(0);
+    for (int c = firstColumn; c <= lastColumn; ++c) {
+        qint64 edge = qBound<qint64>(sampleStore->firstIndex(), qCeil(columnIndex(c) - STORE_TRACE_EDGE_EPSILON), sampleStore->endIndex());
+        if (bounds.isEmpty() || edge > bounds.last()) {
+            bounds.append(edge);
+        }
+    }
+    int count = bounds.size() - 1;
+    if (count < 1) {
+        return false;
+    }
+    buffers->columns.resize(count);
+    sampleStore->decimate(storeChannel, bounds.constData(), count, buffers->columns.data());
+
+    const ChannelScale &scale = sampleStore->scale(storeChannel);
+    buffers->points.resize(4 * count);
+    QPointF *point = buffers->points.data();
+    for (int c = 0; c < count; ++c, point += 4) {
+        const ColumnM4 &column = buffers->columns.at(c);
+        qint64 lo = bounds[c];
+        qint64 hi = bounds[c + 1];
+        double middle = keyOf((lo + hi - 1) / 2.0);
+        point[0] = coordsToPixels(keyOf(lo), column.first * scale.gain + scale.offset);
+        point[1] = coordsToPixels(middle, column.min * scale.gain + scale.offset);
+        point[2] = coordsToPixels(middle, column.max * scale.gain + scale.offset);
+        point[3] = coordsToPixels(keyOf(hi - 1), column.last * scale.gain + scale.offset);
+    }
+    return true;
+}
+
+double StoreTrace::columnIndex(int column) const {
+    return indexOf(mKeyAxis.data()->pixelToCoord(mKeyAxis.data()->axisRect()->left() + column));
+}
+
+bool StoreTrace::isDecimated(void) const {
+    qint64 start, stop;
+    return visibleSpan(&start, &stop) && stop - start > 2 * qMax(1, mKeyAxis.data()->axisRect()->width());
+}
+
+// The column outside each end of the window is included so the lines into it
+// are complete; off the axis rect they are clipped.
+bool StoreTrace::polyline(int firstColumn, int lastColumn, PolylineBuffers *buffers) const {
+    qint64 start, stop;
+    if (!visibleSpan(&start, &stop) || firstColumn >= lastColumn) {
+        return false;
+    }
+    firstColumn -= 1;
+    lastColumn += 1;
+
+    if (stop - start > 2 * qMax(1, mKeyAxis.data()->axisRect()->width())) {
+        return buildColumns(firstColumn, lastColumn, buffers);
+    }
+    double a = columnIndex(firstColumn);
+    double b = columnIndex(lastColumn);
+    start = qMax<qint64>(start, qFloor(qMin(a, b)));
+    stop = qMin<qint64>(stop, qCeil(qMax(a, b)) + 1);
+    if (stop - start < 2) {
+        return false;
+    }
+    buildSamples(start, stop, &buffers->points);
+    return true;
+}
+
+// Same shortcut as QCPGraph: separate lines rasterize faster than one long
+// polyline when the pen is solid and the target is a pixmap.
+void StoreTrace::drawPolyline(QPainter *painter, const QVector<QPointF> &points, bool segments) {
+    if (segments && painter->pen().style() == Qt::SolidLine) {
+        for (int i = 1; i < points.size(); ++i) {
+            painter->drawLine(points[i - 1], points[i]);
+        }
+    } else {
+        painter->drawPolyline(points.constData(), points.size());
+    }
+}
+
+void StoreTrace::draw(QCPPainter *painter) {
+    bool exporting = painter->modes().testFlag(QCPPainter::pmVectorized) || painter->modes().testFlag(QCPPainter::pmNoCaching);
+    if ((rasterized && !glView && !exporting) || mainPen().style() == Qt::NoPen) {
+        return;
+    }
+    if (!polyline(0, mKeyAxis.data()->axisRect()->width(), &buffers)) {
+        return;
+    }
+
+    if (glView && !exporting) {
+        glView->addTrace(buffers.points, mainPen().color(), mainPen().widthF());
+        return;
+    }
+
+    applyDefaultAntialiasingHint(painter);
+    painter->setPen(mainPen());
+    painter->setBrush(Qt::NoBrush);
+    drawPolyline(painter, buffers.points, mParentPlot->plottingHints().testFlag(QCP::phFastPolylines) && !exporting);
+}
+
+void StoreTrace::drawLegendIcon(QCPPainter *painter, const QRectF &rect) const {
+    applyDefaultAntialiasingHint(painter);
+    painter->setPen(mPen);
+    painter->drawLine(QLineF(rect.left(), rect.center().y(), rect.right(), rect.center().y()));
+}
+
+QCPRange StoreTrace::getKeyRange(bool &foundRange, SignDomain inSignDomain) const {
+    foundRange = false;
+    if (!sampleStore || sampleStore->isEmpty()) {
+        return QCPRange();
+    }
+    QCPRange range(keyOf(sampleStore->firstIndex()), keyOf(sampleStore->endIndex() - 1));
+    foundRange = !(inSignDomain == sdPositive && range.upper <= 0) && !(inSignDomain == sdNegative && range.lower >= 0);
+    return range;
+}
+
+// The whole history's extremes come from the top of the pyramid, so this is
+// as cheap as a single pixel column.
+QCPRange StoreTrace::getValueRange(bool &foundRange, SignDomain inSignDomain) const {
+    foundRange = false;
+    if (!sampleStore || sampleStore->isEmpty()) {
+        return QCPRange();
+    }
+    int16_t low, high;
+    sampleStore->rangeMinMax(storeChannel, sampleStore->firstIndex(), sampleStore->endIndex(), &low, &high);
+    const ChannelScale &scale = sampleStore->scale(storeChannel);
+    double a = low * scale.gain + scale.offset;
+    double b = high * scale.gain + scale.offset;
+    QCPRange range(qMin(a, b), qMax(a, b));
+    foundRange = !(inSignDomain == sdPositive && range.upper <= 0) && !(inSignDomain == sdNegative && range.lower >= 0);
+    return range;
+}
@@ -0,0 +1,42 @@
+#include "streamsource.h"
+
+StreamSource::StreamSource(int channels, QObject *parent) : DataSource(parent), channels(channels), parser(channels), lastReadTime(0), bytesRead(0), parseErrors(0), droppedBytes(0), bufferedBytes(0) {
+}
+
+void StreamSource::resetStream(void) {
+    parser.reset();
+    clock.start();
+    lastReadTime = 0;
+}
+
+int StreamSource::readFrames(int16_t *frames, qint64 *timestamps, int maxFrames) {
+    qint64 size;
+    qint64 total = 0;
+    while ((size = readBytes(parser.reserve(PARSER_READ_SIZE), PARSER_READ_SIZE)) > 0) {
+        parser.commit(size);
+        lastReadTime = clock.nsecsElapsed();
+        total += size;
+    }
+
+    int count = parser.takeFrames(frames, maxFrames);
+    for (int i = 0; i < count; ++i) {
+        timestamps[i] = lastReadTime;
+    }
+
+    if (total > 0 || count > 0) {
+        bytesRead.storeRelease(bytesRead.loadAcquire() + total);
+        parseErrors.storeRelease(parser.parseErrors());
+        droppedBytes.storeRelease(parser.droppedBytes());
+        bufferedBytes.storeRelease(parser.bufferedBytes());
+    }
+    return count;
+}
+
+SourceStats StreamSource::stats(void) const {
+    SourceStats stats;
+    stats.bytes = bytesRead.loadAcquire();
+    stats.parseErrors = parseErrors.loadAcquire();
+    stats.droppedBytes = droppedBytes.loadAcquire();
+    stats.bufferedBytes = bufferedBytes.loadAcquire();
+    return stats;
+}
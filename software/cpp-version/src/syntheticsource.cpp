@@ -0,0 +1,85 @@
+#include <QtMath>
+
+#include "syntheticsource.h"
+
+SyntheticSource::SyntheticSource(int channels, double sampleRate, QObject *parent) : DataSource(parent), rate(sampleRate), glitchRate(1.0), opened(false), isPaused(false), pausedAt(0), pausedTotal(0), generated(0) {
+    static const Channel defaults[] = {
+        { Sine, 2.0, 400.0, 512.0 },
+        { Square, 5.0, 300.0, 512.0 },
+        { Noise, 0.0, 100.0, 512.0 },
+        { Sine, 50.0, 200.0, 256.0 }
+    };
+    for (int i = 0; i < channels; ++i) {
+        generators.append(defaults[i % 4]);
+    }
+}
+
+bool SyntheticSource::open(QString *error) {
+    Q_UNUSED(error);
+    random.seed(1);
+    generated = 0;
+    pausedTotal = 0;
+    isPaused = false;
+    clock.start();
+    opened = true;
+    return true;
+}
+
+void SyntheticSource::pause(void) {
+    if (!isPaused) {
+        isPaused = true;
+        pausedAt = clock.nsecsElapsed();
+    }
+}
+
+bool SyntheticSource::resume(QString *error) {
+    Q_UNUSED(error);
+    if (isPaused) {
+        isPaused = false;
+        pausedTotal += clock.nsecsElapsed() - pausedAt;
+    }
+    return opened;
+}
+
+int16_t SyntheticSource::sample(const Channel &generator, double t) {
+    double value = generator.offset;
+    switch (generator.waveform) {
+    case Sine:
+        value += generator.amplitude * qSin(2 * M_PI * generator.frequency * t);
+        break;
+    case Square:
+        value += std::fmod(generator.frequency * t, 1.0) < 0.5 ? generator.amplitude : -generator.amplitude;
+        break;
+    case Noise:
+        value += generator.amplitude * std::uniform_real_distribution<double>(-1.0, 1.0)(random);
+        break;
+    }
+    return static_cast<int16_t>(qBound(0, qRound(value), SYNTHETIC_FULL_SCALE));
+}
+
+int SyntheticSource::readFrames(int16_t *frames, qint64 *timestamps, int maxFrames) {
+    if (!opened || isPaused) {
+        return 0;
+    }
+
+    qint64 due = qint64((clock.nsecsElapsed() - pausedTotal) * rate / 1e9);
+    int count = int(qMin<qint64>(maxFrames, due - generated));
+    int channels = generators.size();
+    double glitchProbability = glitchRate / rate;
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+    for (int n = 0; n < count; ++n) {
+        double t = generated / rate;
+        for (int i = 0; i < channels; ++i) {
+            frames[n * channels + i] = sample(generators[i], t);
+        }
+        if (glitchProbability > 0 && uniform(random) < glitchProbability) {
+            int channel = std::uniform_int_distribution<int>(0, channels - 1)(random);
+            frames[n * channels + channel] = uniform(random) < 0.5 ? 0 : SYNTHETIC_FULL_SCALE;
+        }
+        timestamps[n] = qint64(generated * 1e9 / rate);
+        ++generated;
+    }
+
+    return qMax(0, count);
+}
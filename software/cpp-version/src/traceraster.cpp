@@ -0,0 +1,186 @@
+#include <QRunnable>
+#include <QThread>
+#include <cstring>
+
+#include "traceraster.h"
+
+class TraceRaster::TileJob : public QRunnable {
+public:
+    TileJob(TraceRaster *raster, Tile *tile) : raster(raster), tile(tile) {}
+    void run(void) override { raster->rasterize(tile); }
+
+private:
+    TraceRaster *raster;
+    Tile *tile;
+};
+
+// Sits on the traces' layer, above them.
+TraceRaster::TraceRaster(QCustomPlot *plot) : QCPLayerable(plot), segments(false), frameBits(nullptr), scrolling(false), frameValid(false), drawnColumnIndex(0), drawnColumnSamples(0), drawnEnd(0) {
+    pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 1));
+}
+
+TraceRaster::~TraceRaster(void) {
+    pool.waitForDone();
+}
+
+void TraceRaster::setTraces(const QVector<StoreTrace*> &newTraces) {
+    traces = newTraces;
+    frameValid = false;
+}
+
+void TraceRaster::setScrolling(bool enabled) {
+    scrolling = enabled;
+    if (!enabled) {
+        frameValid = false;
+    }
+}
+
+void TraceRaster::applyDefaultAntialiasingHint(QCPPainter *painter) const {
+    applyAntialiasingHint(painter, mAntialiased, QCP::aePlottables);
+}
+
+QRect TraceRaster::clipRect(void) const {
+    return mParentPlot->axisRect()->rect();
+}
+
+void TraceRaster::draw(QCPPainter *painter) {
+    if (painter->modes().testFlag(QCPPainter::pmVectorized) || painter->modes().testFlag(QCPPainter::pmNoCaching)) {
+        return;
+    }
+
+    // Everything the workers need from the plot is gathered here, on the GUI
+    // thread; they only call the traces' const polyline().
+    layers.resize(0);
+    for (auto trace : traces) {
+        if (!trace->store() || !trace->realVisibility() || !trace->isRasterized() || trace->pen().style() == Qt::NoPen) {
+            continue;
+        }
+        Layer layer;
+        layer.trace = trace;
+        layer.pen = trace->pen();
+        layer.antialiased = mParentPlot->notAntialiasedElements().testFlag(QCP::aePlottables) ? false
+            : mParentPlot->antialiasedElements().testFlag(QCP::aePlottables) ? true : trace->antialiased();
+        layer.decimated = trace->isDecimated();
+        layers.append(layer);
+    }
+    if (layers.isEmpty()) {
+        frameValid = false;
+        return;
+    }
+    segments = mParentPlot->plottingHints().testFlag(QCP::phFastPolylines);
+
+    area = mParentPlot->axisRect()->rect();
+    QSize size(qMax(1, area.width()), qMax(1, area.height()));
+    if (frame.size() != size) {
+        frame = QImage(size, QImage::Format_ARGB32_Premultiplied);
+        frameValid = false;
+    }
+    frameBits = frame.bits();
+
+    int shift, from;
+    if (canScroll(&shift, &from)) {
+        scroll(shift);
+        strip.firstColumn = from;
+        strip.lastColumn = size.width();
+        if (strip.firstColumn < strip.lastColumn) {
+            rasterize(&strip);
+        }
+    } else {
+        layoutTiles(size.width());
+        for (int i = 1; i < tiles.size(); ++i) {
+            pool.start(new TileJob(this, &tiles[i]));
+        }
+        rasterize(&tiles[0]);
+        pool.waitForDone();
+    }
+
+    const StoreTrace *trace = layers.first().trace;
+    drawnLayers = layers;
+    drawnValueRange = trace->valueAxis()->range();
+    drawnColumnIndex = trace->columnIndex(0);
+    drawnColumnSamples = trace->columnIndex(1) - drawnColumnIndex;
+    drawnEnd = trace->store()->endIndex();
+    frameValid = scrolling;
+
+    painter->drawImage(area.topLeft(), frame);
+}
+
+// The frame can be reused when it shows the same traces the same way and the
+// X range kept its size and moved forward by whole columns, less than a frame.
+// Columns before the one where the data ended stay as they were; from there on
+// they are redrawn for the new samples, starting a little earlier so the lines
+// joining old and new ones are complete.
+bool TraceRaster::canScroll(int *shift, int *from) const {
+    if (!scrolling || !frameValid || layers != drawnLayers) {
+        return false;
+    }
+    const StoreTrace *trace = layers.first().trace;
+    if (trace->valueAxis()->range() != drawnValueRange) {
+        return false;
+    }
+    double index = trace->columnIndex(0);
+    double samples = trace->columnIndex(1) - index;
+    if (samples <= 0 || qAbs(samples - drawnColumnSamples) > STORE_TRACE_EDGE_EPSILON * samples) {
+        return false;
+    }
+    double columns = (index - drawnColumnIndex) / samples;
+    *shift = qRound(columns);
+    if (*shift < 0 || *shift >= frame.width() || qAbs(columns - *shift) > TRACE_RASTER_SCROLL_SLACK) {
+        return false;
+    }
+    // Samples the ring has dropped would otherwise stay on screen, as would
+    // those of a store that was cleared since.
+    const SampleStore *store = trace->store();
+    qint64 end = store->endIndex();
+    if (store->firstIndex() > qFloor(index) || end < drawnEnd) {
+        return false;
+    }
+
+    if (*shift == 0 && end == drawnEnd) {
+        *from = frame.width();
+        return true;
+    }
+    double endColumn = qFloor((drawnEnd - 1 - index) / samples);
+    *from = qBound(0, int(qMin<double>(frame.width() - *shift, endColumn)) - TRACE_RASTER_EDGE_COLUMNS, frame.width());
+    return true;
+}
+
+// Moves every row of the frame shift pixels to the left.
+void TraceRaster::scroll(int shift) {
+    if (shift <= 0) {
+        return;
+    }
+    int bytes = (frame.width() - shift) * 4;
+    for (int y = 0; y < frame.height(); ++y) {
+        uchar *row = frameBits + y * frame.bytesPerLine();
+        std::memmove(row, row + shift * 4, bytes);
+    }
+}
+
+// Tiles keep their scratch buffers from frame to frame.
+void TraceRaster::layoutTiles(int width) {
+    int count = qBound(1, width / TRACE_RASTER_MIN_TILE_WIDTH, threadCount());
+    tiles.resize(count);
+    for (int i = 0; i < count; ++i) {
+        tiles[i].firstColumn = width * i / count;
+        tiles[i].lastColumn = width * (i + 1) / count;
+    }
+}
+
+// Each tile paints into its own columns of the frame through an image sharing
+// the frame's memory, so no two threads touch the same pixels.
+void TraceRaster::rasterize(Tile *tile) {
+    QImage image(frameBits + tile->firstColumn * 4, tile->lastColumn - tile->firstColumn, frame.height(), frame.bytesPerLine(), QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    QPainter painter(&image);
+    painter.translate(-(area.left() + tile->firstColumn), -area.top());
+    painter.setBrush(Qt::NoBrush);
+    for (const Layer &layer : layers) {
+        if (!layer.trace->polyline(tile->firstColumn - TRACE_RASTER_EDGE_COLUMNS, tile->lastColumn + TRACE_RASTER_EDGE_COLUMNS, &tile->buffers)) {
+            continue;
+        }
+        painter.setPen(layer.pen);
+        painter.setRenderHint(QPainter::Antialiasing, layer.antialiased);
+        StoreTrace::drawPolyline(&painter, tile->buffers.points, segments);
+    }
+}
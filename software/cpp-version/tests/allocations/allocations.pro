@@ -0,0 +1,15 @@
+QT = core serialport
+
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+QMAKE_CXXFLAGS += -std=c++17
+
+OBJECTS_DIR = obj
+MOC_DIR = moc
+
+TARGET = test-allocations
+TEMPLATE = app
+
+include(../../core.pri)
+
+SOURCES += main.cpp
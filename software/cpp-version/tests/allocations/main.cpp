@@ -0,0 +1,221 @@
+#include <QElapsedTimer>
+#include <QVector>
+#include <QByteArray>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include "streamsource.h"
+#include "sourcereader.h"
+#include "samplestore.h"
+
+// Checks that LineParser, SourceReader's block ring and SampleStore stop
+// allocating once they are warm: every heap allocation made by any thread while
+// counting is enabled is a failure. Only the steady state is counted; opening
+// the source and starting the reader thread happen before, and the GUI's
+// Acquisition, which doesn't go through SourceReader, isn't covered. Qt's
+// containers allocate with malloc() rather than operator new, so on glibc the
+// malloc family is counted as well.
+
+#define TEST_CHANNELS 4
+#define TEST_LINES 4096
+#define TEST_PARSER_ROUNDS 1000
+#define TEST_STORE_CAPACITY (SAMPLE_BLOCK_SIZE * 16)
+#define TEST_WARMUP_BLOCKS (READER_QUEUE_BLOCKS * 4)
+#define TEST_READER_FRAMES 4000000
+
+static std::atomic<bool> counting(false);
+static std::atomic<long long> allocations(0);
+
+static inline void countAllocation(void) {
+    if (counting.load(std::memory_order_relaxed)) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+// Kept out of line so the compiler doesn't pair an inlined free() with a call
+// to operator new and warn about a mismatch.
+Q_NEVER_INLINE void *operator new(std::size_t size) {
+    countAllocation();
+    void *data = std::malloc(size ? size : 1);
+    if (!data) {
+        throw std::bad_alloc();
+    }
+    return data;
+}
+
+Q_NEVER_INLINE void *operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+Q_NEVER_INLINE void operator delete(void *data) noexcept {
+    std::free(data);
+}
+
+Q_NEVER_INLINE void operator delete[](void *data) noexcept {
+    std::free(data);
+}
+
+Q_NEVER_INLINE void operator delete(void *data, std::size_t) noexcept {
+    std::free(data);
+}
+
+Q_NEVER_INLINE void operator delete[](void *data, std::size_t) noexcept {
+    std::free(data);
+}
+
+#ifdef __GLIBC__
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *data, size_t size);
+
+void *malloc(size_t size) {
+    countAllocation();
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+    countAllocation();
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *data, size_t size) {
+    countAllocation();
+    return __libc_realloc(data, size);
+}
+}
+#endif
+
+static void startCounting(void) {
+    allocations.store(0);
+    counting.store(true);
+}
+
+static long long stopCounting(void) {
+    counting.store(false);
+    return allocations.load();
+}
+
+// Serves the same block of lines forever, one read's worth per readFrames()
+// like a port that always has a full buffer waiting.
+class MemorySource : public StreamSource {
+public:
+    explicit MemorySource(const QByteArray &text) : StreamSource(TEST_CHANNELS), text(text), served(0), opened(false), ready(false) {}
+
+    QString name(void) const override { return "Memory"; }
+    bool open(QString *error) override { Q_UNUSED(error); resetStream(); served = 0; opened = true; return true; }
+    void close(void) override { opened = false; }
+    bool isOpen(void) const override { return opened; }
+    bool atEnd(void) const override { return false; }
+
+    int readFrames(int16_t *frames, qint64 *timestamps, int maxFrames) override {
+        ready = true;
+        return StreamSource::readFrames(frames, timestamps, maxFrames);
+    }
+
+protected:
+    qint64 readBytes(char *data, qint64 maxSize) override {
+        if (!ready) {
+            return 0;
+        }
+        ready = false;
+        for (qint64 done = 0; done < maxSize;) {
+            qint64 offset = (served + done) % text.size();
+            qint64 chunk = qMin(maxSize - done, text.size() - offset);
+            memcpy(data + done, text.constData() + offset, chunk);
+            done += chunk;
+        }
+        served += maxSize;
+        return maxSize;
+    }
+
+private:
+    QByteArray text;
+    qint64 served;
+    bool opened;
+    bool ready;
+};
+
+static QByteArray firmwareLines(int lines) {
+    QByteArray text;
+    char line[64];
+    for (int i = 0; i < lines; ++i) {
+        int size = snprintf(line, sizeof(line), "%d\t%d\t%d\t%d\r\n", i % 1024, (i * 7) % 1024, 512, 1023 - i % 1024);
+        text.append(line, size);
+    }
+    return text;
+}
+
+static bool testParser(const QByteArray &text) {
+    LineParser parser(TEST_CHANNELS);
+    QVector<int16_t> frames(READER_BATCH_FRAMES * TEST_CHANNELS);
+    qint64 total = 0;
+    for (int round = -1; round < TEST_PARSER_ROUNDS; ++round) {
+        if (round == 0) {
+            startCounting();
+        }
+        parser.feed(text.constData(), text.size());
+        int count;
+        while ((count = parser.takeFrames(frames.data(), READER_BATCH_FRAMES)) > 0) {
+            total += count;
+        }
+    }
+    long long counted = stopCounting();
+
+    printf("parser: %lld frames, %lld allocations\n", (long long)total, counted);
+    return counted == 0 && parser.parseErrors() == 0;
+}
+
+// The reader's ring reaches its full size once every slot has been handed
+// over, and the store once it has wrapped; from then on nothing allocates.
+static bool testReader(const QByteArray &text) {
+    MemorySource source(text);
+    QElapsedTimer epoch;
+    epoch.start();
+    SourceReader reader(&source, &epoch);
+    SampleStore store(TEST_CHANNELS, TEST_STORE_CAPACITY);
+
+    QString error;
+    if (!reader.open(&error)) {
+        fprintf(stderr, "reader: %s\n", qPrintable(error));
+        return false;
+    }
+
+    FrameBlock block;
+    qint64 blocks = 0;
+    qint64 countedFrom = -1;
+    while (countedFrom < 0 || store.endIndex() - countedFrom < TEST_READER_FRAMES) {
+        if (countedFrom < 0 && blocks >= TEST_WARMUP_BLOCKS && store.endIndex() > 2 * store.capacity()) {
+            countedFrom = store.endIndex();
+            startCounting();
+        }
+        if (!reader.takeBlock(block)) {
+            QThread::yieldCurrentThread();
+            continue;
+        }
+        ++blocks;
+        for (int i = 0; i < block.count; ++i) {
+            store.append(block.frames.constData() + i * TEST_CHANNELS);
+        }
+    }
+    long long counted = stopCounting();
+    reader.close();
+
+    printf("reader: %lld frames, %lld allocations\n", (long long)(store.endIndex() - countedFrom), counted);
+    return counted == 0;
+}
+
+int main(void) {
+    QByteArray text = firmwareLines(TEST_LINES);
+    bool ok = testParser(text);
+    ok = testReader(text) && ok;
+    if (!ok) {
+        fprintf(stderr, "FAIL\n");
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
@@ -0,0 +1,22 @@
+QT = core serialport
+
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+QMAKE_CXXFLAGS += -std=c++17
+
+OBJECTS_DIR = obj
+MOC_DIR = moc
+
+TARGET = test-conversion
+TEMPLATE = app
+
+include(../../core.pri)
+
+SOURCES += \
+    main.cpp \
+    ../../src/csvwriter.cpp \
+    ../../src/headlesslogger.cpp
+
+HEADERS += \
+    ../../include/csvwriter.h \
+    ../../include/headlesslogger.h
@@ -0,0 +1,125 @@
+#include <QCoreApplication>
+#include <QTemporaryDir>
+#include <QFile>
+#include <cstdio>
+
+#include "headlesslogger.h"
+#include "capturewriter.h"
+#include "capturereader.h"
+#include "capturereplay.h"
+
+// Converts a capture the way "uart-scope-cli --replay" does, to a capture and
+// to CSV, and checks that every frame of the source arrives in the output. The
+// replay runs at full speed, far faster than the logger drains it, so frames
+// only survive if the pipeline holds the replay back instead of dropping.
+
+#define TEST_CHANNELS 4
+#define TEST_FRAMES (1 << 20)
+#define TEST_FRAME_NS 10000
+
+static int16_t sampleAt(qint64 frame, int channel) {
+    return int16_t((frame * (channel + 1)) % 4096 - 2048);
+}
+
+static bool writeSource(const QString &path) {
+    CaptureWriter writer(TEST_CHANNELS);
+    writer.setBlocking(true);
+    QString error;
+    if (!writer.open(path, QVector<ChannelScale>(TEST_CHANNELS), &error)) {
+        fprintf(stderr, "source: %s\n", qPrintable(error));
+        return false;
+    }
+    int16_t frame[TEST_CHANNELS];
+    for (qint64 n = 0; n < TEST_FRAMES; ++n) {
+        for (int i = 0; i < TEST_CHANNELS; ++i) {
+            frame[i] = sampleAt(n, i);
+        }
+        writer.append(frame, n * TEST_FRAME_NS);
+    }
+    writer.close();
+    return writer.framesWritten() == TEST_FRAMES;
+}
+
+static bool convert(const QString &source, const QString &output) {
+    CaptureReplay *replay = new CaptureReplay(source);
+    replay->setSpeed(REPLAY_SPEED_MAX);
+    HeadlessLogger logger(replay);
+    QObject::connect(&logger, &HeadlessLogger::finished, QCoreApplication::instance(), &QCoreApplication::quit);
+
+    QString error;
+    if (!logger.start(output, 0, 0, &error)) {
+        fprintf(stderr, "convert: %s\n", qPrintable(error));
+        return false;
+    }
+    QCoreApplication::exec();
+    return !logger.hasFailed();
+}
+
+static bool checkCapture(const QString &path) {
+    CaptureReader reader;
+    QString error;
+    if (!reader.open(path, &error)) {
+        fprintf(stderr, "capture: %s\n", qPrintable(error));
+        return false;
+    }
+
+    bool same = true;
+    qint64 frames = 0;
+    CaptureChunk chunk;
+    for (int c = 0; c < reader.chunkCount() && same; ++c) {
+        if (!reader.readChunk(c, chunk)) {
+            fprintf(stderr, "capture: chunk %d unreadable\n", c);
+            return false;
+        }
+        for (int n = 0; n < chunk.frames && same; ++n) {
+            qint64 frame = chunk.firstFrame + n;
+            for (int i = 0; i < TEST_CHANNELS; ++i) {
+                same = same && chunk.channelData(i)[n] == sampleAt(frame, i);
+            }
+        }
+        frames += chunk.frames;
+    }
+
+    printf("capture: %lld of %d frames%s\n", (long long)reader.frameCount(), TEST_FRAMES, same ? "" : ", samples differ");
+    return same && frames == TEST_FRAMES && reader.frameCount() == quint64(TEST_FRAMES);
+}
+
+static bool checkCsv(const QString &path) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        fprintf(stderr, "csv: %s\n", qPrintable(file.errorString()));
+        return false;
+    }
+    qint64 rows = -1;
+    char data[1 << 16];
+    qint64 size;
+    while ((size = file.read(data, sizeof(data))) > 0) {
+        for (qint64 i = 0; i < size; ++i) {
+            rows += data[i] == '\n';
+        }
+    }
+
+    printf("csv: %lld of %d frames\n", (long long)rows, TEST_FRAMES);
+    return rows == TEST_FRAMES;
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QTemporaryDir dir;
+    QString source = dir.filePath("source." CAPTURE_EXTENSION);
+    QString capture = dir.filePath("converted." CAPTURE_EXTENSION);
+    QString csv = dir.filePath("converted." CSV_EXTENSION);
+    if (!dir.isValid() || !writeSource(source)) {
+        fprintf(stderr, "FAIL: could not write the source capture\n");
+        return 1;
+    }
+
+    bool ok = convert(source, capture) && checkCapture(capture);
+    ok = convert(source, csv) && checkCsv(csv) && ok;
+    if (!ok) {
+        fprintf(stderr, "FAIL\n");
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
@@ -0,0 +1,7 @@
+# Stand-alone test programs; each exits non-zero on failure and "make check"
+# runs them all:
+#   cd tests && qmake && make && make check
+
+TEMPLATE = subdirs
+
+SUBDIRS = allocations conversion
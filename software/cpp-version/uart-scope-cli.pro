@@ -0,0 +1,27 @@
+QT = core serialport
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+QMAKE_CXXFLAGS += -std=c++17
+
+DESTDIR = bin
+OBJECTS_DIR = bin/obj-cli
+MOC_DIR = bin/moc-cli
+
+INCLUDEPATH += include
+
+TARGET = uart-scope-cli
+TEMPLATE = app
+
+include(core.pri)
+
+SOURCES += \
+    src/climain.cpp \
+    src/csvwriter.cpp \
+    src/headlesslogger.cpp
+
+HEADERS += \
+    include/csvwriter.h \
+    include/headlesslogger.h
+
+QMAKE_POST_LINK += $$system(mkdir -p $$DESTDIR $$OBJECTS_DIR $$MOC_DIR)
@@ -14,15 +14,39 @@ INCLUDEPATH += include \
 TARGET = uart-scope
 TEMPLATE = app
 
+include(core.pri)
+
 SOURCES += \
     src/main.cpp \
     src/mainwindow.cpp \
     src/plotmanager.cpp \
+    src/storetrace.cpp \
+    src/traceraster.cpp \
+    src/phosphor.cpp \
+    src/phosphorview.cpp \
+    src/spectrum.cpp \
+    src/spectrogram.cpp \
+    src/gltraceview.cpp \
+    src/acquisition.cpp \
+    src/statsmonitor.cpp \
+    src/renderscheduler.cpp \
+    src/portwatcher.cpp \
     lib/qcustomplot/qcustomplot.cpp
 
 HEADERS += \
     include/mainwindow.h \
     include/plotmanager.h \
+    include/storetrace.h \
+    include/traceraster.h \
+    include/phosphor.h \
+    include/phosphorview.h \
+    include/spectrum.h \
+    include/spectrogram.h \
+    include/gltraceview.h \
+    include/acquisition.h \
+    include/statsmonitor.h \
+    include/renderscheduler.h \
+    include/portwatcher.h \
     lib/qcustomplot/qcustomplot.h
 
 QMAKE_POST_LINK += $$system(mkdir -p $$DESTDIR $$OBJECTS_DIR $$MOC_DIR)